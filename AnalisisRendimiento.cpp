@@ -0,0 +1,456 @@
+#include "AnalisisRendimiento.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+// 📌 Modelo del procesador
+// -----------------------------------------------------------------------------
+
+namespace {
+    constexpr int TOTAL_PUERTOS = 8;
+    constexpr uint8_t P0 = 1 << 0, P1 = 1 << 1, P2 = 1 << 2, P3 = 1 << 3;
+    constexpr uint8_t P4 = 1 << 4, P5 = 1 << 5, P6 = 1 << 6, P7 = 1 << 7;
+    constexpr uint8_t P0156 = P0 | P1 | P5 | P6, P06 = P0 | P6, P15 = P1 | P5;
+    constexpr uint8_t P015 = P0 | P1 | P5, P01 = P0 | P1;
+    constexpr uint8_t P23 = P2 | P3, P237 = P2 | P3 | P7;
+
+    constexpr double ANCHO_EMISION = 4.0;  // uops por ciclo
+    constexpr int LATENCIA_CARGA = 5;      // L1 con acierto (y reenvío desde un almacenamiento)
+    constexpr int ITERACIONES = 8;         // Vueltas simuladas para medir la recurrencia
+
+    // Registros de 32 bits (código del ModR/M), EFLAGS como noveno y detrás
+    // los XMM
+    constexpr int BANDERAS = 8;
+    constexpr int REGISTROS = PRIMER_REGISTRO_XMM + 8;
+    const char* const NOMBRES_REGISTROS[REGISTROS] = {
+        "EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI", "EFLAGS",
+        "XMM0", "XMM1", "XMM2", "XMM3", "XMM4", "XMM5", "XMM6", "XMM7"
+    };
+
+    constexpr uint32_t bit(int r) { return 1u << r; }
+
+    // Coste de la parte de cálculo; las cargas y almacenamientos se suman aparte
+    struct Coste {
+        uint8_t latencia;
+        uint8_t uops;
+        uint8_t puertos;    // Puertos donde puede ejecutarse cada uop
+    };
+
+    // Qué lee y escribe una instrucción y cuánto cuesta
+    struct Efecto {
+        uint32_t lee = 0;       // Registros de datos leídos
+        uint32_t escribe = 0;
+        bool carga = false;
+        bool almacena = false;
+        Coste coste{1, 1, P0156};
+    };
+
+    Efecto efecto(const InstruccionAnalizada& ins) {
+        Efecto e;
+        auto es = [&](int k, ClaseOperando c) { return k < ins.total_ops && ins.clase[k] == c; };
+        auto leer = [&](int k) {
+            if (es(k, ClaseOperando::REGISTRO)) e.lee |= bit(ins.reg[k]);
+            if (es(k, ClaseOperando::MEMORIA)) e.carga = true;
+        };
+        auto escribir = [&](int k) {
+            if (es(k, ClaseOperando::REGISTRO)) e.escribe |= bit(ins.reg[k]);
+            if (es(k, ClaseOperando::MEMORIA)) e.almacena = true;
+        };
+
+        switch (ins.mnem) {
+            case Mnemonico::MOV:
+                leer(1); escribir(0);
+                if (e.carga || e.almacena) e.coste = {1, 0, 0};
+                break;
+            case Mnemonico::LEA:
+                escribir(0);
+                e.coste = {1, 1, P15};
+                break;
+            case Mnemonico::PUSH:
+                // El motor de pila actualiza ESP sin coste
+                leer(0); e.almacena = true;
+                e.coste = {1, 0, 0};
+                break;
+            case Mnemonico::POP:
+                escribir(0); e.carga = true;
+                e.coste = {1, 0, 0};
+                break;
+            case Mnemonico::XCHG:
+                leer(0); leer(1); escribir(0); escribir(1);
+                e.coste = {2, 3, P0156};
+                break;
+            case Mnemonico::ADD: case Mnemonico::OR: case Mnemonico::AND: case Mnemonico::SUB:
+            case Mnemonico::XOR: case Mnemonico::ADC: case Mnemonico::SBB:
+                leer(0); leer(1); escribir(0);
+                // XOR r, r y SUB r, r rompen la dependencia con el valor anterior
+                if ((ins.mnem == Mnemonico::XOR || ins.mnem == Mnemonico::SUB) &&
+                    es(0, ClaseOperando::REGISTRO) && es(1, ClaseOperando::REGISTRO) && ins.reg[0] == ins.reg[1]) {
+                    e.lee = 0;
+                }
+                if (ins.mnem == Mnemonico::ADC || ins.mnem == Mnemonico::SBB) e.coste = {1, 1, P06};
+                break;
+            case Mnemonico::CMP: case Mnemonico::TEST:
+                leer(0); leer(1);
+                break;
+            case Mnemonico::INC: case Mnemonico::DEC: case Mnemonico::NOT: case Mnemonico::NEG:
+                leer(0); escribir(0);
+                break;
+            case Mnemonico::MUL: case Mnemonico::DIV: case Mnemonico::IDIV:
+                leer(0);
+                e.lee |= bit(0) | (ins.mnem == Mnemonico::MUL ? 0 : bit(2));
+                e.escribe |= bit(0) | bit(2);
+                e.coste = ins.mnem == Mnemonico::MUL ? Coste{4, 3, P15} : Coste{26, 6, P0};
+                break;
+            case Mnemonico::IMUL:
+                if (ins.total_ops == 1) {
+                    leer(0);
+                    e.lee |= bit(0);
+                    e.escribe |= bit(0) | bit(2);
+                    e.coste = {4, 3, P15};
+                } else {
+                    leer(1); escribir(0);
+                    if (ins.total_ops == 2) leer(0);
+                    e.coste = {3, 1, P1};
+                }
+                break;
+            case Mnemonico::ROL: case Mnemonico::ROR: case Mnemonico::SHL: case Mnemonico::SHR:
+            case Mnemonico::SAR:
+                leer(0); escribir(0);
+                if (es(1, ClaseOperando::REGISTRO)) {
+                    e.lee |= bit(1); // CL
+                    e.coste = {2, 3, P06};
+                } else {
+                    e.coste = {1, 1, P06};
+                }
+                break;
+            case Mnemonico::CDQ:
+                e.lee |= bit(0); e.escribe |= bit(2);
+                e.coste = {1, 1, P06};
+                break;
+            case Mnemonico::LEAVE:
+                e.lee |= bit(5); e.escribe |= bit(5); e.carga = true;
+                break;
+            case Mnemonico::MOVDQA: case Mnemonico::MOVDQU: case Mnemonico::MOVAPS: case Mnemonico::MOVUPS:
+                leer(1); escribir(0);
+                e.coste = (e.carga || e.almacena) ? Coste{1, 0, 0} : Coste{1, 1, P015};
+                break;
+            case Mnemonico::PADDB: case Mnemonico::PADDW: case Mnemonico::PADDD: case Mnemonico::PADDQ:
+            case Mnemonico::PSUBB: case Mnemonico::PSUBW: case Mnemonico::PSUBD: case Mnemonico::PSUBQ:
+            case Mnemonico::PAND: case Mnemonico::PANDN: case Mnemonico::POR: case Mnemonico::PXOR:
+            case Mnemonico::PCMPEQB: case Mnemonico::PCMPEQW: case Mnemonico::PCMPEQD:
+                leer(0); leer(1); escribir(0);
+                // Como XOR r, r: PXOR, PSUB* y PCMPEQ* de un registro consigo mismo no dependen de él
+                if ((ins.mnem == Mnemonico::PXOR || (ins.mnem >= Mnemonico::PSUBB && ins.mnem <= Mnemonico::PSUBQ) ||
+                     ins.mnem >= Mnemonico::PCMPEQB) &&
+                    es(0, ClaseOperando::REGISTRO) && es(1, ClaseOperando::REGISTRO) && ins.reg[0] == ins.reg[1]) {
+                    e.lee = 0;
+                }
+                e.coste = {1, 1, P015};
+                break;
+            case Mnemonico::PMULLW: case Mnemonico::PMULLD:
+                leer(0); leer(1); escribir(0);
+                e.coste = ins.mnem == Mnemonico::PMULLW ? Coste{5, 1, P01} : Coste{10, 2, P01};
+                break;
+            case Mnemonico::PSHUFD:
+                leer(1); escribir(0);
+                e.coste = {1, 1, P5};
+                break;
+            case Mnemonico::ADDPS: case Mnemonico::SUBPS: case Mnemonico::MULPS:
+                leer(0); leer(1); escribir(0);
+                e.coste = {4, 1, P01};
+                break;
+            case Mnemonico::JMP:
+                e.coste = {0, 1, P6};
+                break;
+            case Mnemonico::CALL:
+                e.almacena = true;
+                e.coste = {0, 1, P6};
+                break;
+            case Mnemonico::RET:
+                e.carga = true;
+                e.coste = {0, 1, P6};
+                break;
+            case Mnemonico::NOP: case Mnemonico::INT: case Mnemonico::HLT:
+                e.coste = {0, 1, P0156};
+                break;
+            default:
+                if (es_salto_condicional(ins.mnem)) e.coste = {0, 1, P06};
+                break;
+        }
+
+        switch (efecto_banderas(ins.mnem)) {
+            case EfectoBanderas::ESCRIBE: case EfectoBanderas::PARCIAL: e.escribe |= bit(BANDERAS); break;
+            case EfectoBanderas::LEE:
+                e.lee |= bit(BANDERAS);
+                if (ins.mnem == Mnemonico::ADC || ins.mnem == Mnemonico::SBB) e.escribe |= bit(BANDERAS);
+                break;
+            default: break;
+        }
+        return e;
+    }
+
+    bool termina_bloque(Mnemonico m) {
+        return m == Mnemonico::JMP || m == Mnemonico::RET || m == Mnemonico::HLT || es_salto_condicional(m);
+    }
+
+// -----------------------------------------------------------------------------
+// 🧮 Presión de puertos
+// -----------------------------------------------------------------------------
+
+    struct Presion {
+        double puertos[TOTAL_PUERTOS] = {};
+        size_t uops = 0;
+
+        // Cada uop se reparte a partes iguales entre los puertos que la aceptan
+        void sumar(uint8_t mascara, unsigned cantidad) {
+            if (cantidad == 0 || mascara == 0) return;
+            const int total = __builtin_popcount(mascara);
+            for (int p = 0; p < TOTAL_PUERTOS; ++p) {
+                if (mascara & (1u << p)) puertos[p] += static_cast<double>(cantidad) / total;
+            }
+            uops += cantidad;
+        }
+
+        void sumar(const Efecto& e) {
+            sumar(e.coste.puertos, e.coste.uops);
+            if (e.carga) sumar(P23, 1);
+            if (e.almacena) { sumar(P4, 1); sumar(P237, 1); }
+        }
+
+        int puerto_mas_cargado() const {
+            return static_cast<int>(max_element(puertos, puertos + TOTAL_PUERTOS) - puertos);
+        }
+        double emision() const { return uops / ANCHO_EMISION; }
+        double cota() const { return max(puertos[puerto_mas_cargado()], emision()); }
+    };
+
+// -----------------------------------------------------------------------------
+// ⛓️ Cadenas de dependencias
+// -----------------------------------------------------------------------------
+
+    // Ciclo en que cada valor está disponible ejecutando en orden de datos
+    // (recursos ilimitados) y, para cada valor, la instrucción de mayor
+    // latencia de la cadena que lo produjo
+    struct Cadena {
+        double listo[REGISTROS] = {};
+        int causa[REGISTROS];
+        int productor[REGISTROS];
+        unordered_map<uint64_t, double> memoria;
+        unordered_map<uint64_t, int> causa_memoria;
+        double fin = 0;
+        int ultima = -1;                // Instrucción que termina más tarde
+        vector<int> previa;             // Instrucción -> la que retrasó su inicio (-1 si ninguna)
+
+        Cadena() {
+            fill(causa, causa + REGISTROS, -1);
+            fill(productor, productor + REGISTROS, -1);
+        }
+    };
+
+    int peso(const InstruccionAnalizada& ins) {
+        Efecto e = efecto(ins);
+        return e.coste.latencia + (e.carga ? LATENCIA_CARGA : 0);
+    }
+
+    void simular(const vector<InstruccionAnalizada>& instrucciones, size_t inicio, size_t fin, Cadena& c) {
+        c.previa.assign(fin - inicio, -1);
+        for (size_t i = inicio; i < fin; ++i) {
+            const InstruccionAnalizada& ins = instrucciones[i];
+            const Efecto e = efecto(ins);
+
+            double comienzo = 0;
+            int causa = -1, previa = -1;
+            auto esperar = [&](double t, int causa_valor, int productor) {
+                if (t > comienzo) { comienzo = t; causa = causa_valor; previa = productor; }
+            };
+            for (int r = 0; r < REGISTROS; ++r) {
+                if (e.lee & bit(r)) esperar(c.listo[r], c.causa[r], c.productor[r]);
+            }
+            if (e.carga || e.almacena || ins.mnem == Mnemonico::LEA) {
+                // La dirección se calcula antes que nada
+                for (int r = 0; r < 8; ++r) {
+                    if (ins.regs_direccion & bit(r)) esperar(c.listo[r], c.causa[r], c.productor[r]);
+                }
+            }
+            if (e.carga) {
+                auto it = c.memoria.find(ins.clave_memoria);
+                if (it != c.memoria.end()) esperar(it->second, c.causa_memoria[ins.clave_memoria], -1);
+                comienzo += LATENCIA_CARGA;
+            }
+
+            const int propio = static_cast<int>(i);
+            if (causa < 0 || peso(ins) >= peso(instrucciones[causa])) causa = propio;
+            const double listo = comienzo + e.coste.latencia;
+
+            for (int r = 0; r < REGISTROS; ++r) {
+                if (!(e.escribe & bit(r))) continue;
+                c.listo[r] = listo;
+                c.causa[r] = causa;
+                c.productor[r] = propio;
+            }
+            if (e.almacena) {
+                c.memoria[ins.clave_memoria] = listo;
+                c.causa_memoria[ins.clave_memoria] = causa;
+            }
+            c.previa[i - inicio] = previa;
+            if (listo >= c.fin) { c.fin = listo; c.ultima = propio; }
+        }
+    }
+
+// -----------------------------------------------------------------------------
+// 📤 Informe
+// -----------------------------------------------------------------------------
+
+    string formatear(double v) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.2f", v);
+        return buf;
+    }
+
+    void escribir_presion(ostream& os, const Presion& p) {
+        os << "    presión por puerto:";
+        for (int k = 0; k < TOTAL_PUERTOS; ++k) {
+            if (p.puertos[k] > 0) os << "  P" << k << " " << formatear(p.puertos[k]);
+        }
+        os << "\n";
+    }
+
+    void escribir_cadena(ostream& os, const vector<InstruccionAnalizada>& instrucciones, size_t inicio,
+                         const Cadena& c) {
+        if (c.ultima < 0) return;
+        vector<int> camino;
+        for (int i = c.ultima; i >= 0; i = c.previa[i - inicio]) {
+            camino.push_back(i);
+        }
+        os << "    cadena crítica (" << formatear(c.fin) << " ciclos):";
+        for (size_t k = camino.size(); k-- > 0;) {
+            os << (k + 1 == camino.size() ? " " : " -> ") << nombre_mnemonico(instrucciones[camino[k]].mnem);
+        }
+        os << "\n";
+    }
+
+    bool llama_fuera(const vector<InstruccionAnalizada>& instrucciones, size_t inicio, size_t fin) {
+        for (size_t i = inicio; i < fin; ++i) {
+            Mnemonico m = instrucciones[i].mnem;
+            if (m == Mnemonico::CALL || m == Mnemonico::INT) return true;
+        }
+        return false;
+    }
+}
+
+void escribir_analisis_rendimiento(const vector<InstruccionAnalizada>& instrucciones,
+                                   const vector<EtiquetaAnalizada>& etiquetas,
+                                   const InternadorSimbolos& simbolos, ostream& os) {
+    os << "Análisis estático de rendimiento\n"
+       << "Modelo: " << ANCHO_EMISION << " uops/ciclo; cálculo en P0 P1 P5 P6, cargas en P2 P3 ("
+       << LATENCIA_CARGA << " ciclos), almacenamiento en P4 + P2 P3 P7\n\n";
+    if (instrucciones.empty()) {
+        os << "Sin instrucciones.\n";
+        return;
+    }
+
+    // Primera etiqueta de cada instrucción y dónde está cada símbolo
+    vector<uint32_t> etiqueta_en(instrucciones.size() + 1, InternadorSimbolos::NINGUNO);
+    unordered_map<uint32_t, uint32_t> instruccion_de;
+    for (const EtiquetaAnalizada& e : etiquetas) {
+        if (etiqueta_en[e.instruccion] == InternadorSimbolos::NINGUNO) etiqueta_en[e.instruccion] = e.simbolo;
+        instruccion_de[e.simbolo] = e.instruccion;
+    }
+
+    // Nombre de un bloque: su etiqueta o la última anterior más un desplazamiento
+    auto nombre_bloque = [&](size_t inicio) {
+        for (size_t i = inicio + 1; i-- > 0;) {
+            if (etiqueta_en[i] == InternadorSimbolos::NINGUNO) continue;
+            string nombre(simbolos.nombre(etiqueta_en[i]));
+            return i == inicio ? nombre : nombre + "+" + to_string(inicio - i);
+        }
+        return "inicio" + (inicio ? "+" + to_string(inicio) : string());
+    };
+
+    // 1. Bloques básicos: empiezan en una etiqueta o tras un salto
+    os << "== Bloques básicos ==\n";
+    size_t inicio = 0;
+    for (size_t i = 0; i < instrucciones.size(); ++i) {
+        const bool ultimo = i + 1 == instrucciones.size();
+        if (!ultimo && !termina_bloque(instrucciones[i].mnem) && etiqueta_en[i + 1] == InternadorSimbolos::NINGUNO) {
+            continue;
+        }
+
+        Presion presion;
+        for (size_t k = inicio; k <= i; ++k) presion.sumar(efecto(instrucciones[k]));
+        Cadena cadena;
+        simular(instrucciones, inicio, i + 1, cadena);
+
+        os << nombre_bloque(inicio) << ": " << (i + 1 - inicio) << " instr., " << presion.uops
+           << " uops, rendimiento " << formatear(presion.cota()) << " ciclos, latencia "
+           << formatear(cadena.fin) << " ciclos\n";
+        escribir_presion(os, presion);
+        escribir_cadena(os, instrucciones, inicio, cadena);
+        inicio = i + 1;
+    }
+
+    // 2. Bucles: cada salto hacia atrás a una etiqueta cierra una región que
+    //    se analiza como traza lineal (los saltos internos se suponen no tomados)
+    os << "\n== Bucles ==\n";
+    size_t bucles = 0;
+    for (size_t j = 0; j < instrucciones.size(); ++j) {
+        const InstruccionAnalizada& salto = instrucciones[j];
+        if (salto.destino == InternadorSimbolos::NINGUNO) continue;
+        if (salto.mnem != Mnemonico::JMP && !es_salto_condicional(salto.mnem)) continue;
+        auto it = instruccion_de.find(salto.destino);
+        if (it == instruccion_de.end() || it->second > j) continue;
+        const size_t cabeza = it->second;
+        ++bucles;
+
+        Presion presion;
+        for (size_t k = cabeza; k <= j; ++k) presion.sumar(efecto(instrucciones[k]));
+
+        // Recurrencia: cuánto se retrasa cada valor por vuelta en régimen estable
+        Cadena cadena;
+        double mitad[REGISTROS] = {};
+        for (int v = 0; v < ITERACIONES; ++v) {
+            if (v == ITERACIONES / 2) copy(cadena.listo, cadena.listo + REGISTROS, mitad);
+            simular(instrucciones, cabeza, j + 1, cadena);
+        }
+        double recurrencia = 0;
+        int registro = -1;
+        vector<pair<double, int>> arrastradas;
+        for (int r = 0; r < REGISTROS; ++r) {
+            const double por_vuelta = (cadena.listo[r] - mitad[r]) / (ITERACIONES / 2);
+            if (por_vuelta <= 0) continue;
+            if (r != BANDERAS) arrastradas.push_back({por_vuelta, r});
+            if (por_vuelta > recurrencia) { recurrencia = por_vuelta; registro = r; }
+        }
+        sort(arrastradas.rbegin(), arrastradas.rend());
+
+        const double ciclos = max(recurrencia, presion.cota());
+        os << simbolos.nombre(salto.destino) << " (" << (j + 1 - cabeza) << " instr., " << presion.uops
+           << " uops): ~" << formatear(ciclos) << " ciclos/iteración, limitado por ";
+        if (recurrencia >= presion.cota() && registro >= 0 && cadena.causa[registro] >= 0) {
+            os << "la latencia de " << nombre_mnemonico(instrucciones[cadena.causa[registro]].mnem)
+               << " (dependencia en " << NOMBRES_REGISTROS[registro] << ")";
+        } else if (presion.emision() >= presion.puertos[presion.puerto_mas_cargado()]) {
+            os << "el ancho de emisión (" << presion.uops << " uops a " << ANCHO_EMISION << " por ciclo)";
+        } else {
+            os << "el puerto P" << presion.puerto_mas_cargado();
+        }
+        os << "\n";
+
+        os << "    dependencias entre iteraciones:";
+        if (arrastradas.empty()) os << " ninguna";
+        for (size_t k = 0; k < arrastradas.size(); ++k) {
+            const auto& [por_vuelta, r] = arrastradas[k];
+            os << (k ? ", " : " ") << NOMBRES_REGISTROS[r] << " " << formatear(por_vuelta);
+            if (cadena.causa[r] >= 0) os << " (" << nombre_mnemonico(instrucciones[cadena.causa[r]].mnem) << ")";
+        }
+        os << "\n";
+        escribir_presion(os, presion);
+        if (llama_fuera(instrucciones, cabeza, j + 1)) {
+            os << "    nota: incluye CALL/INT; no se modela lo que ejecutan\n";
+        }
+    }
+    if (bucles == 0) os << "Ninguno.\n";
+}
@@ -0,0 +1,55 @@
+#ifndef ANALISIS_RENDIMIENTO_HPP
+#define ANALISIS_RENDIMIENTO_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "TablaOpcodes.hpp"
+#include "InternadorSimbolos.hpp"
+
+using namespace std;
+
+// --- REGISTRO DE INSTRUCCIONES PARA EL ANÁLISIS ---
+// Resumen de cada instrucción emitida, sin vistas sobre la fuente: sólo lo
+// que hace falta para saber qué registros y direcciones lee y escribe.
+constexpr uint8_t PRIMER_REGISTRO_XMM = 9;  // XMMn -> PRIMER_REGISTRO_XMM + n (tras EFLAGS)
+
+enum class ClaseOperando : uint8_t {
+    NINGUNO,
+    REGISTRO,   // reg = registro de 32 bits que lo contiene (AL/AH -> EAX) o XMMn
+    MEMORIA,    // Base e índice en InstruccionAnalizada::regs_direccion
+    INMEDIATO,
+    ETIQUETA
+};
+
+struct InstruccionAnalizada {
+    Mnemonico mnem;
+    uint8_t total_ops;
+    ClaseOperando clase[3];
+    uint8_t reg[3];
+    uint8_t regs_direccion;     // Máscara de registros usados para formar direcciones
+    uint64_t clave_memoria;     // Misma expresión de dirección -> misma clave
+    uint32_t destino;           // Símbolo destino de un salto (NINGUNO si no hay)
+    int32_t posicion;           // En .text, para quitar lo que borran las optimizaciones
+};
+
+struct EtiquetaAnalizada {
+    uint32_t instruccion;       // Índice de la primera instrucción tras la etiqueta
+    uint32_t simbolo;
+};
+
+// --- ANÁLISIS ESTÁTICO DE RENDIMIENTO ---
+// Al estilo de llvm-mca, con un modelo fijo de núcleo superescalar (4 uops por
+// ciclo; puertos 0, 1, 5 y 6 de cálculo, 2 y 3 de carga, 4 de datos de
+// almacenamiento y 7 de direcciones). Divide el programa en bloques básicos y
+// estima para cada uno la presión por puerto y la cadena crítica de
+// dependencias; para cada bucle (salto hacia atrás a una etiqueta) estima los
+// ciclos por iteración y la dependencia entre iteraciones que los limita.
+// Son cotas de un modelo, no mediciones: no hay cachés, predicción de saltos
+// ni fusión de instrucciones.
+void escribir_analisis_rendimiento(const vector<InstruccionAnalizada>& instrucciones,
+                                   const vector<EtiquetaAnalizada>& etiquetas,
+                                   const InternadorSimbolos& simbolos, ostream& os);
+
+#endif // ANALISIS_RENDIMIENTO_HPP
@@ -0,0 +1,182 @@
+#include "CacheSalidas.hpp"
+#include "ModulosPrecompilados.hpp"
+
+#include <cstdio>
+#include <dirent.h>
+#include <fcntl.h>
+#include <functional>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIA[4] = {'E', 'I', 'S', 'A'};
+    constexpr uint32_t VERSION_FORMATO = 1;
+    constexpr const char* EXTENSION = ".eis";
+
+    bool dependencias_vigentes(const vector<DependenciaModulo>& dependencias) {
+        for (const DependenciaModulo& d : dependencias) {
+            LectorFuente lector;
+            if (!lector.abrir(d.ruta) || hash_contenido(lector.contenido()) != d.hash) return false;
+        }
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 📌 Clave
+// -----------------------------------------------------------------------------
+
+CacheSalidas::CacheSalidas(const string& directorio_cache, uint64_t limite)
+    : directorio(directorio_cache), limite_bytes(limite), tamano_conocido(false), tamano_estimado(0) {
+    mkdir(directorio.c_str(), 0755);
+}
+
+uint64_t CacheSalidas::clave(string_view fuente, const string& formato, string_view opciones) {
+    uint64_t h = hash_contenido(fuente);
+    auto mezclar = [&h](string_view s) {
+        for (char c : s) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        h = (h ^ 0xFF) * 1099511628211ull; // Separador
+    };
+    mezclar(VERSION_ENSAMBLADOR);
+    mezclar(formato);
+    mezclar(opciones);
+    return h;
+}
+
+string CacheSalidas::ruta_entrada(uint64_t clave) const {
+    char nombre[32];
+    snprintf(nombre, sizeof(nombre), "%016llx", static_cast<unsigned long long>(clave));
+    return directorio + "/" + nombre + EXTENSION;
+}
+
+// -----------------------------------------------------------------------------
+// 🔎 Búsqueda
+// -----------------------------------------------------------------------------
+
+bool CacheSalidas::buscar(uint64_t clave, EntradaCacheSalida& entrada) {
+    const string ruta = ruta_entrada(clave);
+    LectorFuente archivo;
+    if (!archivo.abrir(ruta)) {
+        ++fallos;
+        return false;
+    }
+
+    LectorBinario l{archivo.contenido()};
+    bool valida = l.hay(sizeof(MAGIA)) && archivo.contenido().substr(0, sizeof(MAGIA)) == string_view(MAGIA, 4);
+    if (valida) {
+        l.p += sizeof(MAGIA);
+        valida = l.u32() == VERSION_FORMATO && l.u64() == clave;
+    }
+    if (valida) {
+        entrada.dependencias.resize(l.cuenta(12));
+        for (DependenciaModulo& d : entrada.dependencias) {
+            d.hash = l.u64();
+            d.ruta = l.texto();
+        }
+        entrada.salida = l.texto();
+        entrada.simbolos = l.texto();
+        entrada.referencias = l.texto();
+        entrada.diagnosticos = l.texto();
+        valida = l.ok && dependencias_vigentes(entrada.dependencias);
+    }
+    if (!valida) {
+        ++fallos;
+        return false;
+    }
+
+    // Marcar el uso para la expulsión LRU
+    utimensat(AT_FDCWD, ruta.c_str(), nullptr, 0);
+    ++aciertos;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// 💾 Guardado y expulsión
+// -----------------------------------------------------------------------------
+
+void CacheSalidas::guardar(uint64_t clave, const EntradaCacheSalida& entrada) {
+    string datos;
+    datos.reserve(64 + entrada.salida.size() + entrada.simbolos.size() + entrada.referencias.size() +
+                  entrada.diagnosticos.size());
+    EscritorBinario e{datos};
+    e.bytes(MAGIA, sizeof(MAGIA));
+    e.u32(VERSION_FORMATO);
+    e.u64(clave);
+    e.u32(static_cast<uint32_t>(entrada.dependencias.size()));
+    for (const DependenciaModulo& d : entrada.dependencias) {
+        e.u64(d.hash);
+        e.texto(d.ruta);
+    }
+    e.texto(entrada.salida);
+    e.texto(entrada.simbolos);
+    e.texto(entrada.referencias);
+    e.texto(entrada.diagnosticos);
+
+    // Una entrada mayor que todo el límite no se guarda
+    if (datos.size() > limite_bytes) return;
+    expulsar_si_lleno(datos.size());
+
+    const string ruta = ruta_entrada(clave);
+    const string temporal = ruta + "." + to_string(getpid()) + "." +
+                            to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+    if (!volcar_archivo(temporal, datos.data(), datos.size()) || rename(temporal.c_str(), ruta.c_str()) != 0) {
+        unlink(temporal.c_str());
+    }
+}
+
+void CacheSalidas::expulsar_si_lleno(uint64_t bytes_nuevos) {
+    /*
+        El tamaño ocupado se mide recorriendo el directorio sólo la primera vez
+        y cuando la estimación pasa del límite; entonces se borran las entradas
+        de uso más antiguo hasta quedar en el 90 % del límite, para no tener
+        que recorrerlo de nuevo en cada escritura.
+    */
+    lock_guard<mutex> bloqueo(cerrojo);
+    if (tamano_conocido && tamano_estimado + bytes_nuevos <= limite_bytes) {
+        tamano_estimado += bytes_nuevos;
+        return;
+    }
+
+    struct Archivo {
+        string ruta;
+        timespec uso;
+        uint64_t tamano;
+    };
+    vector<Archivo> archivos;
+    uint64_t total = 0;
+    if (DIR* dir = opendir(directorio.c_str())) {
+        const size_t largo_extension = char_traits<char>::length(EXTENSION);
+        while (dirent* d = readdir(dir)) {
+            string_view nombre = d->d_name;
+            if (nombre.size() <= largo_extension || nombre.substr(nombre.size() - largo_extension) != EXTENSION) {
+                continue;
+            }
+            Archivo a;
+            a.ruta = directorio + "/" + string(nombre);
+            struct stat info{};
+            if (stat(a.ruta.c_str(), &info) != 0) continue;
+            a.uso = info.st_mtim;
+            a.tamano = static_cast<uint64_t>(info.st_size);
+            total += a.tamano;
+            archivos.push_back(move(a));
+        }
+        closedir(dir);
+    }
+
+    if (total + bytes_nuevos > limite_bytes) {
+        sort(archivos.begin(), archivos.end(), [](const Archivo& a, const Archivo& b) {
+            return a.uso.tv_sec != b.uso.tv_sec ? a.uso.tv_sec < b.uso.tv_sec : a.uso.tv_nsec < b.uso.tv_nsec;
+        });
+        const uint64_t objetivo = limite_bytes / 10 * 9;
+        for (const Archivo& a : archivos) {
+            if (total + bytes_nuevos <= objetivo) break;
+            if (unlink(a.ruta.c_str()) == 0) {
+                total -= a.tamano;
+                ++expulsadas;
+            }
+        }
+    }
+    tamano_conocido = true;
+    tamano_estimado = total + bytes_nuevos;
+}
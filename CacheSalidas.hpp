@@ -0,0 +1,57 @@
+#ifndef CACHE_SALIDAS_HPP
+#define CACHE_SALIDAS_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+using namespace std;
+
+// Todo lo que deja un ensamblado: la salida, los reportes y los mensajes
+// (para volver a mostrarlos y devolver el mismo código de salida)
+struct EntradaCacheSalida {
+    vector<DependenciaModulo> dependencias; // %include: si cambian, la entrada no vale
+    string salida;
+    string simbolos;
+    string referencias;
+    string diagnosticos;
+};
+
+// --- CACHÉ DE SALIDAS POR CONTENIDO ---
+// Una entrada por archivo <clave>.eis, donde la clave es el hash de la fuente,
+// la versión del ensamblador y las opciones que cambian la salida. Un acierto
+// cuesta el hash de la fuente (y de sus %include) y la lectura de la entrada.
+// La fecha de modificación de cada entrada es su último uso: al pasar del
+// límite de tamaño se borran las menos usadas recientemente (LRU). Varios
+// procesos pueden compartir el directorio: las escrituras son atómicas.
+class CacheSalidas {
+private:
+    string directorio;
+    uint64_t limite_bytes;
+
+    mutex cerrojo;
+    bool tamano_conocido;       // Si ya se recorrió el directorio
+    uint64_t tamano_estimado;   // Bytes ocupados (lo recorrido más lo escrito desde entonces)
+
+    string ruta_entrada(uint64_t clave) const;
+    void expulsar_si_lleno(uint64_t bytes_nuevos);
+
+public:
+    atomic<uint64_t> aciertos{0};
+    atomic<uint64_t> fallos{0};
+    atomic<uint64_t> expulsadas{0};
+
+    CacheSalidas(const string& directorio_cache, uint64_t limite);
+
+    // 'opciones' resume las opciones que cambian la salida (-O, --alinear-bucles)
+    static uint64_t clave(string_view fuente, const string& formato, string_view opciones);
+
+    bool buscar(uint64_t clave, EntradaCacheSalida& entrada);
+    void guardar(uint64_t clave, const EntradaCacheSalida& entrada);
+};
+
+#endif // CACHE_SALIDAS_HPP
@@ -0,0 +1,27 @@
+#include "Estadisticas.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Reemplazo global de operator new para --stats: se enlaza sólo en los
+// programas (no en la biblioteca) y suma en los contadores de Estadisticas.hpp
+// mientras asignaciones::activo está encendido. Va en su propia unidad de
+// traducción para que el compilador no mezcle estas funciones con las llamadas.
+
+void* operator new(size_t tamano) {
+    if (asignaciones::activo.load(memory_order_relaxed)) {
+        asignaciones::total.fetch_add(1, memory_order_relaxed);
+        asignaciones::bytes.fetch_add(tamano, memory_order_relaxed);
+    }
+    if (tamano == 0) tamano = 1;
+    if (void* p = malloc(tamano)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
@@ -0,0 +1,127 @@
+#include "EnsambladoIncremental.hpp"
+#include "ModulosPrecompilados.hpp"
+
+// -----------------------------------------------------------------------------
+// 📌 Inicialización
+// -----------------------------------------------------------------------------
+
+EnsambladoIncremental::EnsambladoIncremental(const string& formato_salida)
+    : generacion(0), formato(formato_salida) {}
+
+uint64_t EnsambladoIncremental::hash_bloque(string_view texto) {
+    // FNV-1a de 64 bits
+    uint64_t h = 14695981039346656037ull;
+    for (char c : texto) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    return h;
+}
+
+// -----------------------------------------------------------------------------
+// 🗃️ Caché de bloques
+// -----------------------------------------------------------------------------
+
+const FragmentoCodificado& EnsambladoIncremental::obtener_bloque(string_view texto, SeccionELF seccion,
+                                                                 ResumenIncremental& resumen) {
+    // El mismo texto en otra sección es otro bloque
+    const uint64_t h = (hash_bloque(texto) ^ static_cast<uint8_t>(seccion)) * 1099511628211ull;
+    auto it = cache.find(h);
+    if (it != cache.end() && it->second.longitud == texto.size()) {
+        bool vigente = true;
+        for (const DependenciaModulo& d : it->second.dependencias) {
+            LectorFuente lector;
+            if (!lector.abrir(d.ruta) || hash_contenido(lector.contenido()) != d.hash) {
+                vigente = false;
+                break;
+            }
+        }
+        if (vigente) {
+            it->second.generacion = generacion;
+            incluidos.insert(incluidos.end(), it->second.dependencias.begin(), it->second.dependencias.end());
+            ++resumen.reutilizados;
+            return it->second.fragmento;
+        }
+    }
+
+    // Bloque nuevo o editado: se codifica desde la posición 0 con el borrador
+    ostringstream mensajes;
+    borrador.reiniciar();
+    borrador.diagnosticos = &mensajes;
+    borrador.fijar_origen(archivo_fuente);
+    borrador.seleccionar_seccion(seccion);
+    borrador.ensamblar_texto(texto);
+
+    EntradaCache& entrada = cache[h];
+    borrador.extraer_fragmento(entrada.fragmento);
+    entrada.fragmento.diagnosticos = mensajes.str();
+    entrada.longitud = texto.size();
+    entrada.generacion = generacion;
+    entrada.dependencias = borrador.dependencias;
+    incluidos.insert(incluidos.end(), entrada.dependencias.begin(), entrada.dependencias.end());
+    ++resumen.recodificados;
+    return entrada.fragmento;
+}
+
+// -----------------------------------------------------------------------------
+// 🔁 Actualización
+// -----------------------------------------------------------------------------
+
+bool EnsambladoIncremental::actualizar(const string& archivo_entrada, const string& archivo_salida,
+                                       ResumenIncremental& resumen) {
+    const uint64_t t0 = reloj_ns();
+    resumen = ResumenIncremental();
+    ++generacion;
+
+    LectorFuente lector;
+    if (!lector.abrir(archivo_entrada)) {
+        *programa.diagnosticos << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+        return false;
+    }
+    const string_view texto = lector.contenido();
+    archivo_fuente = archivo_entrada;
+    incluidos.clear();
+
+    // 1. Cortar en bloques y tomar cada uno de la caché o codificarlo; cada
+    //    bloque empieza en la sección en la que terminó el anterior
+    bloques.clear();
+    size_t inicio_bloque = 0;
+    SeccionELF seccion = SeccionELF::TEXTO;
+    EscanerLineas escaner(texto);
+    LineaEscaneada linea;
+    while (escaner.siguiente(linea)) {
+        if (linea.comienzo > inicio_bloque && EnsambladorIA32::es_frontera_segura(linea)) {
+            bloques.push_back(&obtener_bloque(texto.substr(inicio_bloque, linea.comienzo - inicio_bloque), seccion, resumen));
+            seccion = bloques.back()->seccion_final;
+            inicio_bloque = linea.comienzo;
+        }
+    }
+    if (inicio_bloque < texto.size()) {
+        bloques.push_back(&obtener_bloque(texto.substr(inicio_bloque), seccion, resumen));
+    }
+    resumen.bloques = bloques.size();
+
+    // 2. Enlazar todos los bloques: copia de código y traducción de símbolos
+    size_t total_codigo = 0;
+    for (const FragmentoCodificado* bloque : bloques) total_codigo += bloque->codigo.size();
+    programa.reiniciar();
+    programa.codigo_hex.reserve(total_codigo);
+    for (const FragmentoCodificado* bloque : bloques) programa.enlazar_codificado(*bloque);
+    programa.resolver_referencias_pendientes();
+
+    // 3. Descartar de la caché los bloques que ya no aparecen
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.generacion != generacion) it = cache.erase(it);
+        else ++it;
+    }
+
+    // 4. Escribir sólo lo que cambió
+    string salida;
+    bool correcto = programa.construir_salida(formato, salida);
+    if (correcto) {
+        const bool ejecutable = formato == "exe";
+        correcto = actualizar_archivo(archivo_salida, salida_anterior, salida, ejecutable, resumen.bytes_escritos);
+        if (correcto) salida_anterior.swap(salida);
+        else *programa.diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+    }
+
+    resumen.ns = reloj_ns() - t0;
+    return correcto;
+}
@@ -0,0 +1,78 @@
+#ifndef ENSAMBLADO_INCREMENTAL_HPP
+#define ENSAMBLADO_INCREMENTAL_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+using namespace std;
+
+// Resumen de una actualización
+struct ResumenIncremental {
+    size_t bloques = 0;         // Bloques de la versión actual
+    size_t reutilizados = 0;    // Tomados de la caché
+    size_t recodificados = 0;   // Analizados y codificados de nuevo
+    size_t bytes_escritos = 0;  // Bytes realmente escritos en la salida
+    uint64_t ns = 0;            // Duración total
+};
+
+// --- ENSAMBLADO INCREMENTAL ---
+// La fuente se corta en bloques en cada etiqueta o SECTION (las mismas
+// fronteras que el ensamblado paralelo). Cada bloque se codifica una vez y se
+// guarda por el hash de su texto; en las siguientes versiones sólo se
+// codifican los bloques nuevos o editados. El enlace, la relajación y los
+// parches se rehacen sobre el código en caché, y en la salida sólo se
+// reescriben los tramos que cambian.
+class EnsambladoIncremental {
+private:
+    struct EntradaCache {
+        FragmentoCodificado fragmento;
+        size_t longitud;        // Longitud del texto (segunda comprobación además del hash)
+        uint64_t generacion;    // Última versión que lo usó
+        vector<DependenciaModulo> dependencias; // %include del bloque: si cambian, se recodifica
+    };
+
+    unordered_map<uint64_t, EntradaCache> cache; // Hash del texto del bloque -> fragmento
+    vector<const FragmentoCodificado*> bloques;  // Bloques de la versión actual, en orden
+    uint64_t generacion;
+
+    EnsambladorIA32 borrador;   // Codifica los bloques sueltos
+    EnsambladorIA32 programa;   // Programa enlazado de la última versión
+    string formato;             // hex, bin, elf o exe
+    string salida_anterior;     // Contenido actual del archivo de salida
+    string archivo_fuente;      // Origen de las rutas de %include
+    vector<DependenciaModulo> incluidos; // Archivos incluidos por la versión actual
+
+    static uint64_t hash_bloque(string_view texto);
+    const FragmentoCodificado& obtener_bloque(string_view texto, SeccionELF seccion, ResumenIncremental& resumen);
+
+public:
+    explicit EnsambladoIncremental(const string& formato_salida = "hex");
+
+    // Reensambla 'archivo_entrada' reutilizando lo posible y actualiza
+    // 'archivo_salida'. Devuelve false si no se pudo leer o escribir.
+    bool actualizar(const string& archivo_entrada, const string& archivo_salida, ResumenIncremental& resumen);
+
+    // Optimización de mirilla (-O) en los bloques y en la relajación. Debe
+    // fijarse antes de la primera actualización: la caché no distingue
+    void activar_optimizacion(bool activa = true) {
+        borrador.activar_optimizacion(activa);
+        programa.activar_optimizacion(activa);
+    }
+
+    // Grafo de flujo (-O2) y alineación de cabeceras de bucle: sólo afectan
+    // al enlace del programa
+    void activar_optimizacion_flujo(bool activa = true) { programa.activar_optimizacion_flujo(activa); }
+    void activar_alineacion_bucles(const AlineacionBucles& bucles) { programa.activar_alineacion_bucles(bucles); }
+
+    // Archivos incluidos (a cualquier nivel) por la última actualización
+    const vector<DependenciaModulo>& archivos_incluidos() const { return incluidos; }
+
+    // Programa de la última actualización (tablas de símbolos, reportes)
+    EnsambladorIA32& resultado() { return programa; }
+};
+
+#endif // ENSAMBLADO_INCREMENTAL_HPP
@@ -1,11 +1,17 @@
 #include "EnsambladorIA32.hpp"
+#include "ModulosPrecompilados.hpp"
+#include <climits>
 #include <cstdint>
+#include <cstring>
+#include <elf.h>
 
 // -----------------------------------------------------------------------------
 // 📌 Inicialización
 // -----------------------------------------------------------------------------
 
-EnsambladorIA32::EnsambladorIA32() : contador_posicion(0) {
+EnsambladorIA32::EnsambladorIA32()
+    : contador_posicion(0), diagnosticos(&cerr), seccion_actual(SeccionELF::TEXTO), alineacion_datos(4),
+      optimizar(false), optimizar_flujo(false), alineacion_maxima(1), analizar(false), salida_continua(nullptr), base_continua(0), parche_libre(SIN_PARCHE) {
     inicializar_mapas();
 }
 
@@ -21,27 +27,29 @@ void EnsambladorIA32::inicializar_mapas() {
         {"AL", 0b000}, {"CL", 0b001}, {"DL", 0b010}, {"BL", 0b011},
         {"AH", 0b100}, {"CH", 0b101}, {"DH", 0b110}, {"BH", 0b111}
     };
+
+    // Registros vectoriales (SSE)
+    xmm_map = {
+        {"XMM0", 0b000}, {"XMM1", 0b001}, {"XMM2", 0b010}, {"XMM3", 0b011},
+        {"XMM4", 0b100}, {"XMM5", 0b101}, {"XMM6", 0b110}, {"XMM7", 0b111}
+    };
 }
 
 // -----------------------------------------------------------------------------
 // 🧹 Utilidades
 // -----------------------------------------------------------------------------
 
-void EnsambladorIA32::limpiar_linea(string& linea) {
-    // Quitar comentarios
-    size_t pos = linea.find(';');
-    if (pos != string::npos) linea = linea.substr(0, pos);
+void EnsambladorIA32::limpiar_linea(string_view& linea) {
+    // Quitar comentarios (un ';' entre comillas no abre ninguno)
+    size_t pos = inicio_comentario(linea);
+    if (pos != string_view::npos) linea = linea.substr(0, pos);
 
-    // Eliminar espacios en blanco al inicio y al final
-    auto no_espacio = [](int ch) { return !isspace(ch); };
-    linea.erase(linea.begin(), find_if(linea.begin(), linea.end(), no_espacio));
-    linea.erase(find_if(linea.rbegin(), linea.rend(), no_espacio).base(), linea.end());
-
-    // Convertir a mayúsculas para facilitar el análisis (opcional)
-    transform(linea.begin(), linea.end(), linea.begin(), ::toupper);
+    // Eliminar espacios en blanco al inicio y al final (sin copiar: sólo se
+    // ajusta la vista; las mayúsculas se ignoran al comparar)
+    linea = recortar(linea);
 }
 
-bool EnsambladorIA32::es_etiqueta(const string& s) {
+bool EnsambladorIA32::es_etiqueta(string_view s) {
     // Una etiqueta termina con ':'
     return !s.empty() && s.back() == ':';
 }
@@ -56,6 +64,12 @@ void EnsambladorIA32::agregar_byte(uint8_t byte) {
     contador_posicion += 1;
 }
 
+void EnsambladorIA32::agregar_word(uint16_t word) {
+    // Little-endian para valores de 16 bits
+    agregar_byte(static_cast<uint8_t>(word & 0xFF));
+    agregar_byte(static_cast<uint8_t>((word >> 8) & 0xFF));
+}
+
 void EnsambladorIA32::agregar_dword(uint32_t dword) {
     // Little-endian para valores de 32 bits
     agregar_byte(static_cast<uint8_t>(dword & 0xFF));
@@ -64,466 +78,2623 @@ void EnsambladorIA32::agregar_dword(uint32_t dword) {
     agregar_byte(static_cast<uint8_t>((dword >> 24) & 0xFF));
 }
 
-bool EnsambladorIA32::obtener_reg32(const string& op, uint8_t& reg_code) {
-    if (reg32_map.count(op)) {
-        reg_code = reg32_map.at(op);
+void EnsambladorIA32::agregar_bloque(const uint8_t* datos, size_t n) {
+    codigo_hex.insert(codigo_hex.end(), datos, datos + n);
+    contador_posicion += static_cast<int>(n);
+}
+
+void EnsambladorIA32::agregar_inmediato(const Operando& op, int tamano) {
+    if (tamano == 4 && !op.simbolo.empty()) {
+        // Dirección de una etiqueta: se parchea al resolver
+        registrar_referencia(op.simbolo, 4, 0, static_cast<int32_t>(op.valor));
+        agregar_dword(0);
+        return;
+    }
+
+    if (tamano == 1) agregar_byte(static_cast<uint8_t>(op.valor));
+    else if (tamano == 2) agregar_word(static_cast<uint16_t>(op.valor));
+    else agregar_dword(static_cast<uint32_t>(op.valor));
+}
+
+uint32_t EnsambladorIA32::id_simbolo(string_view etiqueta) {
+    // Interna el nombre y garantiza su entrada en tabla_simbolos
+    uint32_t id = simbolos.internar(etiqueta);
+    if (id >= tabla_simbolos.size()) {
+        tabla_simbolos.resize(id + 1, SIN_DEFINIR);
+        simbolos_globales.resize(id + 1, false);
+        secciones_simbolos.resize(id + 1, SeccionELF::TEXTO);
+    }
+    return id;
+}
+
+void EnsambladorIA32::registrar_referencia(string_view etiqueta, int tamano, int tipo_salto, int32_t sumando) {
+    // La referencia apunta a la posición actual, donde se emitirá el valor;
+    // como el código sólo crece, el arreglo queda ordenado por posición
+    ReferenciaPendiente ref;
+    ref.posicion = static_cast<uint32_t>(contador_posicion);
+    ref.simbolo = id_simbolo(etiqueta);
+    ref.sumando = sumando;
+    ref.tamano_inmediato = static_cast<uint8_t>(tamano);
+    ref.tipo_salto = static_cast<uint8_t>(tipo_salto);
+    referencias_pendientes.push_back(ref);
+}
+
+bool EnsambladorIA32::obtener_reg32(string_view op, uint8_t& reg_code) {
+    auto it = reg32_map.find(op);
+    if (it != reg32_map.end()) {
+        reg_code = it->second;
         return true;
     }
     return false;
 }
 
-// Procesa una referencia a memoria simple del tipo [ETIQUETA] o [ETIQUETA+DISP]
-bool EnsambladorIA32::procesar_mem_simple(const string& operando,
-                                          uint8_t& modrm_byte,
-                                          const uint8_t reg_code,
-                                          bool es_destino,
-                                          uint8_t op_extension) {
-    /*
-        Implementación simplificada:
-        - Asumimos operando del tipo [ETIQUETA]
-        - Se genera un ModR/M con:
-            Mod = 00 (direccionamiento con desplazamiento de 32 bits)
-            R/M = 101 (dirección directa)
-        - El registro (reg/opcode) se elige según reg_code u op_extension
-    */
+bool EnsambladorIA32::obtener_reg8(string_view op, uint8_t& reg_code) {
+    auto it = reg8_map.find(op);
+    if (it != reg8_map.end()) {
+        reg_code = it->second;
+        return true;
+    }
+    return false;
+}
 
-    string op = operando;
-    if (op.front() == '[' && op.back() == ']') {
-        op = op.substr(1, op.size() - 2); // Quitar corchetes
-    } else {
-        return false;
+bool EnsambladorIA32::obtener_xmm(string_view op, uint8_t& reg_code) {
+    auto it = xmm_map.find(op);
+    if (it != xmm_map.end()) {
+        reg_code = it->second;
+        return true;
     }
+    return false;
+}
 
-    // El operando debe ser una etiqueta (sin registros dentro)
-    string etiqueta = op;
+// Procesa una referencia a memoria simple del tipo [ETIQUETA], [ETIQUETA+DISP] o [DIRECCION]
+bool EnsambladorIA32::codificar_memoria(const Operando& operando, uint8_t reg_field) {
+    /*
+        ModR/M (+ SIB) con la forma más corta posible:
+        - [DISP32]             Mod=00 R/M=101
+        - [BASE]               Mod=00 (salvo EBP, que exige Mod=01 con disp8 = 0)
+        - [BASE + disp8]       Mod=01, si el desplazamiento cabe en 8 bits con signo
+        - [BASE + disp32]      Mod=10 (siempre que haya etiqueta: se parchea después)
+        - Con índice o base ESP, R/M=100 y un byte SIB (escala, índice, base);
+          sin base, SIB con base=101 y disp32
+    */
+    if (operando.tipo != TipoOperando::MEMORIA) return false;
 
-    // Reg/opcode field
-    uint8_t mod = 0b00;
-    uint8_t rm  = 0b101; // Dirección absoluta
+    const uint8_t SIN = Operando::SIN_REGISTRO;
+    uint8_t base = operando.base, indice = operando.indice, escala = operando.escala;
 
-    uint8_t reg_field = es_destino ? op_extension : reg_code;
+    // [R*1] es [R] y [R*2] es [R+R]: se evita el SIB sin base, que lleva disp32
+    if (base == SIN && indice != SIN && (escala == 1 || escala == 2)) {
+        base = indice;
+        if (escala == 1) indice = SIN;
+        escala = 1;
+    }
+    // ESP no puede ser índice: con escala 1 se intercambia con la base
+    // (analizar_memoria ya rechazó las demás combinaciones)
+    if (indice == 4) swap(base, indice);
 
-    modrm_byte = generar_modrm(mod, reg_field, rm);
+    const bool con_etiqueta = !operando.simbolo.empty();
+    const int64_t disp = operando.valor;
 
-    // Registrar referencia pendiente para la etiqueta
-    ReferenciaPendiente ref;
-    ref.posicion = contador_posicion + 1; // después del opcode
-    ref.tamano_inmediato = 4;
-    ref.tipo_salto = 0; // Absoluto
-    referencias_pendientes[etiqueta].push_back(ref);
+    if (base == SIN && indice == SIN) {
+        agregar_byte(generar_modrm(0b00, reg_field, 0b101)); // Dirección absoluta
+        agregar_desplazamiento(operando, 4);
+        return true;
+    }
 
-    // Reservar espacio para el desplazamiento (4 bytes)
-    agregar_dword(0);
+    uint8_t mod, tamano_disp;
+    if (base == SIN) {
+        mod = 0b00;
+        tamano_disp = 4;            // SIB sin base: siempre disp32
+    } else if (!con_etiqueta && disp == 0 && base != 5) {
+        mod = 0b00;
+        tamano_disp = 0;
+    } else if (!con_etiqueta && disp >= -128 && disp <= 127) {
+        mod = 0b01;
+        tamano_disp = 1;
+    } else {
+        mod = 0b10;
+        tamano_disp = 4;
+    }
 
+    if (indice == SIN && base != 4) {
+        agregar_byte(generar_modrm(mod, reg_field, base));
+    } else {
+        static const uint8_t BITS_ESCALA[9] = {0, 0, 1, 0, 2, 0, 0, 0, 3};
+        agregar_byte(generar_modrm(mod, reg_field, 0b100));
+        agregar_byte(generar_modrm(BITS_ESCALA[escala], indice == SIN ? 0b100 : indice,
+                                   base == SIN ? 0b101 : base));
+    }
+    if (tamano_disp) agregar_desplazamiento(operando, tamano_disp);
     return true;
 }
 
+void EnsambladorIA32::agregar_desplazamiento(const Operando& operando, int tamano) {
+    if (!operando.simbolo.empty()) {
+        // Registrar referencia pendiente para la etiqueta (DISP va como sumando)
+        registrar_referencia(operando.simbolo, 4, 0, static_cast<int32_t>(operando.valor)); // Absoluto
+        agregar_dword(0); // Reservar espacio para la dirección (4 bytes)
+    } else if (tamano == 1) {
+        agregar_byte(static_cast<uint8_t>(operando.valor));
+    } else {
+        agregar_dword(static_cast<uint32_t>(operando.valor));
+    }
+}
+
 // -----------------------------------------------------------------------------
 // 🧠 Procesamiento de líneas
 // -----------------------------------------------------------------------------
 
-void EnsambladorIA32::procesar_linea(string linea) {
-    limpiar_linea(linea);
+void EnsambladorIA32::procesar_linea(const LineaEscaneada& escaneada) {
+    // El escáner ya quitó el comentario y los espacios de los extremos
+    string_view linea = escaneada.texto;
     if (linea.empty()) return;
 
     if (es_etiqueta(linea)) {
-        procesar_etiqueta(linea.substr(0, linea.size() - 1));
+        procesar_etiqueta(recortar(linea.substr(0, linea.size() - 1)));
         return;
     }
 
-    procesar_instruccion(linea);
-}
-
-void EnsambladorIA32::procesar_etiqueta(const string& etiqueta) {
-    // La etiqueta se almacena con la posición actual del Contador de Posición (CP)
-    tabla_simbolos[etiqueta] = contador_posicion;
-}
-
-void EnsambladorIA32::procesar_instruccion(const string& linea) {
-    stringstream ss(linea);
-    string mnem;
-    ss >> mnem;
-
-    string resto;
-    getline(ss, resto);
-    limpiar_linea(resto);
-
-    if (mnem == "MOV") {
-        procesar_mov(resto);
-    } else if (mnem == "ADD") {
-        procesar_add(resto);
-    } else if (mnem == "SUB") {
-        procesar_sub(resto);
-    } else if (mnem == "JMP") {
-        procesar_jmp(resto);
-    } else if (mnem == "JE" || mnem == "JZ" ||
-               mnem == "JNE" || mnem == "JNZ" ||
-               mnem == "JLE" || mnem == "JL" ||
-               mnem == "JA"  || mnem == "JAE" ||
-               mnem == "JB"  || mnem == "JBE" ||
-               mnem == "JG"  || mnem == "JGE") {
-        procesar_condicional(mnem, resto);
-    } else if (mnem == "INT") {
-        // Implementación simple INT imm8 (CD imm8)
-        stringstream imm_ss(resto);
-        string imm_str;
-        imm_ss >> imm_str;
-        try {
-            uint32_t immediate = stoul(imm_str, nullptr, 16);
-            agregar_byte(0xCD);
-            agregar_byte(static_cast<uint8_t>(immediate));
-        } catch (...) {
-            cerr << "Error: Formato de INT inválido: " << linea << endl;
-        }
-    } else {
-        cerr << "Advertencia: Mnemónico no soportado: " << mnem << endl;
+    // Etiqueta seguida de instrucción en la misma línea (ETIQUETA: INSTR ...)
+    size_t fin_token = escaneada.fin_token;
+    if (fin_token > 1 && linea[fin_token - 1] == ':') {
+        procesar_etiqueta(linea.substr(0, fin_token - 1));
+        linea = recortar(linea.substr(fin_token));
+        fin_token = 0;
+        while (fin_token < linea.size() && !es_espacio(linea[fin_token])) ++fin_token;
     }
+
+    procesar_instruccion(linea, fin_token);
 }
 
-// -----------------------------------------------------------------------------
-// 🧾 Procesamiento específico de instrucciones
-// -----------------------------------------------------------------------------
+void EnsambladorIA32::procesar_etiqueta(string_view etiqueta) {
+    if (estadisticas.activas) ++estadisticas.etiquetas;
+    vaciar_ventana(); // Nadie sabe quién salta aquí: la mirilla no cruza etiquetas
+    const uint32_t id = id_simbolo(etiqueta);
+    if (analizar && seccion_actual == SeccionELF::TEXTO) {
+        etiquetas_analisis.push_back({static_cast<uint32_t>(instrucciones_analisis.size()), id});
+    }
+    // La etiqueta se almacena con la posición actual del Contador de Posición
+    // (CP) de la sección activa
+    tabla_simbolos[id] = contador_posicion;
+    secciones_simbolos[id] = seccion_actual;
+    if (salida_continua && seccion_actual == SeccionELF::TEXTO) resolver_parches_continuos(id);
+}
 
-void EnsambladorIA32::procesar_mov(const string& operandos) {
-    // Formatos soportados (simplificados):
-    // 1. MOV REG, REG
-    // 2. MOV REG, INMEDIATO (hexadecimal)
-    // 3. MOV [ETIQUETA], REG
-    // 4. MOV REG, [ETIQUETA]
+void EnsambladorIA32::procesar_instruccion(string_view linea, size_t fin_mnem) {
+    string_view mnem = linea.substr(0, fin_mnem);
+    string_view resto = recortar(linea.substr(fin_mnem));
+
+    // Despacho O(1): hash perfecto del mnemónico -> rango de formas en la tabla
+    Mnemonico id = buscar_mnemonico(mnem.data(), mnem.size());
+    if (id == Mnemonico::DESCONOCIDO) {
+        // NOMBRE DD ...: etiqueta sin ':' delante de una directiva de datos
+        size_t fin_siguiente = 0;
+        while (fin_siguiente < resto.size() && !es_espacio(resto[fin_siguiente])) ++fin_siguiente;
+        if (es_directiva_datos(buscar_mnemonico(resto.data(), fin_siguiente))) {
+            procesar_etiqueta(mnem);
+            procesar_instruccion(resto, fin_siguiente);
+            return;
+        }
+        *diagnosticos << "Advertencia: Mnemónico no soportado: " << mnem << endl;
+        return;
+    }
 
-    stringstream ss(operandos);
-    string dest_str, src_str;
+    if (es_directiva(id)) {
+        vaciar_ventana();
+        if (estadisticas.activas) {
+            const size_t clase = static_cast<size_t>(ClaseMnemonico::DIRECTIVA);
+            uint64_t t0 = reloj_ns();
+            procesar_directiva(id, resto);
+            estadisticas.ns_codificacion[clase] += reloj_ns() - t0;
+            ++estadisticas.instrucciones_por_clase[clase];
+            return;
+        }
+        procesar_directiva(id, resto);
+        return;
+    }
+    if (seccion_actual != SeccionELF::TEXTO) {
+        *diagnosticos << "Error: Instrucción fuera de .text: " << linea << endl;
+        return;
+    }
 
-    getline(ss, dest_str, ',');
-    ss >> ws;
-    getline(ss, src_str);
+    // Separar operandos por comas
+    Operando ops[3];
+    int total_ops = 0;
+    string_view pendiente = resto;
+    while (!pendiente.empty()) {
+        size_t coma = pendiente.find(',');
+        string_view texto = pendiente.substr(0, coma);
+        if (total_ops == 3 || !analizar_operando(texto, ops[total_ops])) {
+            *diagnosticos << "Error: Operando inválido en " << mnem << ": " << resto << endl;
+            return;
+        }
+        ++total_ops;
+        if (coma == string_view::npos) break;
+        pendiente = pendiente.substr(coma + 1);
+        if (pendiente.empty()) {
+            *diagnosticos << "Error: Operando inválido en " << mnem << ": " << resto << endl;
+            return;
+        }
+    }
 
-    limpiar_linea(dest_str);
-    limpiar_linea(src_str);
+    // Sin BYTE/DWORD explícito, la memoria toma el tamaño del registro que la acompaña
+    for (int k = 0; k < total_ops; ++k) {
+        if (ops[k].tipo != TipoOperando::MEMORIA || ops[k].tamano != 0) continue;
+        for (int j = 0; j < total_ops; ++j) {
+            if (ops[j].tipo == TipoOperando::REG8) ops[k].tamano = 1;
+        }
+    }
 
-    uint8_t dest_code, src_code;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str,  src_code);
+    const uint64_t t0 = estadisticas.activas ? reloj_ns() : 0;
 
-    // 1. MOV REG, REG
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x89); // Opcode 89 (r/m32, r32)
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code); // Mod=11 (Reg-Reg)
-        agregar_byte(modrm);
+    InstruccionIR ins;
+    ins.mnem = id;
+    ins.forma = buscar_forma(id, ops, total_ops);
+    if (!ins.forma) {
+        *diagnosticos << "Error de sintaxis o modo no soportado para " << mnem << ": " << resto << endl;
         return;
     }
+    for (int k = 0; k < total_ops; ++k) ins.ops[k] = ops[k];
+    ins.total_ops = static_cast<uint8_t>(total_ops);
 
-    // 2. MOV REG, INMEDIATO
-    if (dest_is_reg && src_str.size() > 1 && src_str.back() == 'H') {
-        try {
-            uint32_t immediate = stoul(src_str.substr(0, src_str.size() - 1), nullptr, 16);
-            agregar_byte(0xB8 + dest_code); // B8+rd
-            agregar_dword(immediate);
-            return;
-        } catch (...) {
-            cerr << "Error: Inmediato inválido en MOV: " << src_str << endl;
-            return;
-        }
+    if (estadisticas.activas) {
+        estadisticas.ns_codificacion[static_cast<size_t>(clase_mnemonico(id))] += reloj_ns() - t0;
+    }
+
+    if (optimizar) encolar_instruccion(ins);
+    else emitir_instruccion(ins);
+}
+
+void EnsambladorIA32::emitir_instruccion(const InstruccionIR& ins) {
+    const uint64_t t0 = estadisticas.activas ? reloj_ns() : 0;
+
+    const int posicion = contador_posicion;
+    codificar(*ins.forma, ins.ops);
+    if (analizar) registrar_para_analisis(ins, posicion);
+
+    if (estadisticas.activas) {
+        const size_t clase = static_cast<size_t>(clase_mnemonico(ins.mnem));
+        estadisticas.ns_codificacion[clase] += reloj_ns() - t0;
+        ++estadisticas.instrucciones_por_clase[clase];
+        ++estadisticas.instrucciones;
     }
+}
 
-    // 3. MOV Memoria-Registro (MOV [ETIQUETA], EAX)
-    if (src_is_reg && dest_str.size() > 2 && dest_str.front() == '[' && dest_str.back() == ']') {
-        agregar_byte(0x89); // Opcode 89 (r/m32, r32)
-        uint8_t modrm_byte;
-        if (procesar_mem_simple(dest_str, modrm_byte, src_code, true)) return;
+void EnsambladorIA32::procesar_directiva(Mnemonico directiva, string_view operandos) {
+    // SECTION cambia la sección activa; GLOBAL / EXTERN marcan símbolos
+    // visibles desde fuera (tabla de símbolos del ELF)
+    switch (directiva) {
+        case Mnemonico::SECTION: procesar_seccion(operandos); return;
+        case Mnemonico::INCLUDE: incluir_archivo(operandos); return;
+        case Mnemonico::ALIGN: procesar_align(operandos); return;
+        case Mnemonico::DB: case Mnemonico::DW: case Mnemonico::DD: procesar_datos(directiva, operandos); return;
+        case Mnemonico::TIMES: procesar_times(operandos); return;
+        case Mnemonico::RESB: case Mnemonico::RESW: case Mnemonico::RESD: procesar_reserva(directiva, operandos); return;
+        case Mnemonico::INCBIN: incluir_binario(operandos); return;
+        default: break;
     }
-    
-    // 4. MOV Registro-Memoria (MOV EAX, [ETIQUETA])
-    if (dest_is_reg && src_str.size() > 2 && src_str.front() == '[' && src_str.back() == ']') {
-        agregar_byte(0x8B); // Opcode 8B (r32, r/m32)
-        uint8_t modrm_byte;
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return;
+
+    while (!operandos.empty()) {
+        size_t coma = operandos.find(',');
+        string_view nombre = recortar(operandos.substr(0, coma));
+        if (!nombre.empty()) simbolos_globales[id_simbolo(nombre)] = true;
+        if (coma == string_view::npos) break;
+        operandos = operandos.substr(coma + 1);
     }
-    
-    cerr << "Error de sintaxis o modo no soportado para MOV: " << operandos << endl;
 }
 
-void EnsambladorIA32::procesar_add(const string& operandos) {
-    // Aquí podrías implementar ADD de forma similar a MOV/SUB.
-    // Por simplicidad, dejamos un mensaje para indicar que no está implementado.
-    cerr << "Advertencia: Instrucción ADD aún no implementada: " << operandos << endl;
+namespace {
+    SaltoRelajable punto_alineacion(int posicion, uint16_t alineacion, uint16_t relleno_maximo) {
+        SaltoRelajable punto;
+        punto.posicion = posicion;
+        punto.condicional = false;
+        punto.condicion = 0;
+        punto.largo = false;
+        punto.eliminado = false;
+        punto.destino = -1;
+        punto.simbolo = 0;
+        punto.sumando = 0;
+        punto.alineacion = alineacion;
+        punto.relleno_maximo = relleno_maximo;
+        punto.relleno = 0;
+        return punto;
+    }
 }
 
-void EnsambladorIA32::procesar_sub(const string& operandos) {
-    // Formatos soportados (simplificados):
-    // 1. SUB REG, REG
-    // 2. SUB REG, INMEDIATO
-    // 3. SUB [ETIQUETA], INMEDIATO
+void EnsambladorIA32::procesar_align(string_view operandos) {
+    // ALIGN n[, m]: rellena con NOPs hasta un múltiplo de n (potencia de dos,
+    // hasta 4096), salvo que hagan falta más de m bytes (n - 1 por defecto).
+    // El relleno depende del tamaño final de los saltos: aquí sólo se anota.
+    // En .data y .bss se rellena con ceros (alinear_seccion)
+    size_t coma = operandos.find(',');
+    int64_t alineacion = 0, maximo = 0;
+    bool correcto = analizar_inmediato(recortar(operandos.substr(0, coma)), alineacion) &&
+                    alineacion >= 1 && alineacion <= 4096 && (alineacion & (alineacion - 1)) == 0;
+    if (correcto) {
+        maximo = alineacion - 1;
+        if (coma != string_view::npos) {
+            correcto = analizar_inmediato(recortar(operandos.substr(coma + 1)), maximo) && maximo >= 0;
+            maximo = min<int64_t>(maximo, alineacion - 1);
+        }
+    }
+    if (!correcto) {
+        *diagnosticos << "Error: ALIGN necesita una potencia de dos entre 1 y 4096 (y un relleno máximo): "
+                      << operandos << endl;
+        return;
+    }
+    if (alineacion > 1 && salida_continua && seccion_actual == SeccionELF::TEXTO) {
+        alinear_continuo(static_cast<uint16_t>(alineacion), static_cast<uint16_t>(maximo));
+    } else if (alineacion > 1) {
+        saltos_relajables.push_back(punto_alineacion(contador_posicion, static_cast<uint16_t>(alineacion),
+                                                     static_cast<uint16_t>(maximo)));
+    }
+}
 
-    stringstream ss(operandos);
-    string dest_str, src_str;
+namespace {
+    string directorio_de(const string& ruta) {
+        size_t barra = ruta.find_last_of('/');
+        return barra == string::npos ? string() : ruta.substr(0, barra);
+    }
 
-    getline(ss, dest_str, ',');
-    ss >> ws;
-    getline(ss, src_str);
+    string ruta_canonica(const string& ruta) {
+        char* real = realpath(ruta.c_str(), nullptr);
+        string canonica = real ? real : ruta;
+        free(real);
+        return canonica;
+    }
+}
 
-    limpiar_linea(dest_str);
-    limpiar_linea(src_str);
+void EnsambladorIA32::fijar_origen(const string& archivo_entrada) {
+    directorio_fuente = directorio_de(archivo_entrada);
+    pila_inclusion.assign(1, ruta_canonica(archivo_entrada));
+}
 
-    uint8_t dest_code, src_code;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str,  src_code);
+void EnsambladorIA32::incluir_archivo(string_view operandos) {
+    /*
+        El archivo se ensambla una sola vez, aparte y desde la posición 0, como
+        un fragmento del ensamblado paralelo; el módulo resultante se guarda en
+        la caché por el hash de su contenido y aquí sólo se enlaza. Los %include
+        anidados quedan dentro del módulo y en su lista de dependencias.
+    */
+    string_view nombre = recortar(operandos);
+    if (nombre.size() >= 2 && (nombre.front() == '"' || nombre.front() == '\'' || nombre.front() == '<')) {
+        nombre = nombre.substr(1, nombre.size() - 2);
+    }
+    if (nombre.empty()) {
+        *diagnosticos << "Error: %include sin nombre de archivo" << endl;
+        return;
+    }
 
-    // 1. SUB REG, REG
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x29); // SUB r/m32, r32
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code);
-        agregar_byte(modrm);
+    string ruta(nombre);
+    if (ruta[0] != '/' && !directorio_fuente.empty()) ruta = directorio_fuente + "/" + ruta;
+    LectorFuente lector;
+    if (!lector.abrir(ruta)) {
+        *diagnosticos << "Error: No se pudo abrir el archivo incluido: " << ruta << endl;
         return;
     }
 
-    // 2. SUB EAX, INMEDIATO (caso especial)
-    if (dest_is_reg && dest_code == 0 && src_str.size() > 1 && src_str.back() == 'H') {
-        try {
-            uint32_t immediate = stoul(src_str.substr(0, src_str.size() - 1), nullptr, 16);
-            agregar_byte(0x2D); // SUB EAX, imm32
-            agregar_dword(immediate);
-            return;
-        } catch (...) {
-            cerr << "Error: Inmediato inválido en SUB: " << src_str << endl;
+    const string canonica = ruta_canonica(ruta);
+    if (find(pila_inclusion.begin(), pila_inclusion.end(), canonica) != pila_inclusion.end()) {
+        *diagnosticos << "Error: Inclusión circular de " << ruta << endl;
+        return;
+    }
+
+    if (salida_continua) {
+        // Un módulo es código sin relajar desde la posición 0: en la salida
+        // continua el archivo se ensambla en su sitio, como si estuviera escrito aquí
+        dependencias.push_back({canonica, hash_contenido(lector.contenido())});
+        string directorio_anterior = move(directorio_fuente);
+        directorio_fuente = directorio_de(ruta);
+        pila_inclusion.push_back(canonica);
+        ensamblar_texto(lector.contenido());
+        pila_inclusion.pop_back();
+        directorio_fuente = move(directorio_anterior);
+        return;
+    }
+
+    if (!modulos) modulos = make_shared<CacheModulos>();
+    const uint64_t hash = hash_contenido(lector.contenido());
+    const uint64_t clave = clave_modulo(hash, optimizar, seccion_actual);
+
+    shared_ptr<const ModuloPrecompilado> modulo = modulos->buscar(clave);
+    if (!modulo) {
+        auto nuevo = make_shared<ModuloPrecompilado>();
+        ostringstream mensajes;
+        EnsambladorIA32 parte;
+        parte.diagnosticos = &mensajes;
+        parte.optimizar = optimizar;
+        parte.modulos = modulos;
+        parte.directorio_fuente = directorio_de(ruta);
+        parte.pila_inclusion = pila_inclusion;
+        parte.pila_inclusion.push_back(canonica);
+        parte.seleccionar_seccion(seccion_actual);
+        parte.codigo_hex.reserve(lector.contenido().size() / 4);
+        parte.ensamblar_texto(lector.contenido());
+
+        parte.extraer_fragmento(nuevo->fragmento);
+        nuevo->fragmento.diagnosticos = mensajes.str();
+        nuevo->hash = hash;
+        nuevo->dependencias = move(parte.dependencias);
+        ++modulos->ensamblados;
+        // Con diagnósticos no se guarda: el error puede depender de algo que
+        // no está en sus dependencias (un archivo que aún no existe)
+        if (nuevo->fragmento.diagnosticos.empty()) modulos->guardar(clave, nuevo);
+        modulo = move(nuevo);
+    }
+
+    // Un módulo de la caché puede venir de otra cadena de inclusiones
+    for (const DependenciaModulo& d : modulo->dependencias) {
+        if (find(pila_inclusion.begin(), pila_inclusion.end(), d.ruta) != pila_inclusion.end()) {
+            *diagnosticos << "Error: Inclusión circular de " << d.ruta << " (desde " << ruta << ")" << endl;
             return;
         }
     }
 
-    // 3. SUB [ETIQUETA], INMEDIATO (inmediato pequeño)
-    if (!dest_is_reg && dest_str.size() > 2 && dest_str.front() == '[' && dest_str.back() == ']'
-        && src_str.size() > 1 && src_str.back() == 'H') {
-        try {
-            uint32_t immediate = stoul(src_str.substr(0, src_str.size() - 1), nullptr, 16);
-            if (immediate <= 0xFF) {
-                // Opcode: 83 /5 (SUB r/m32, imm8)
-                agregar_byte(0x83);
-                uint8_t op_extension = 0b101; // /5 para SUB
-                uint8_t modrm_byte;
-                if (procesar_mem_simple(dest_str, modrm_byte, 0, true, op_extension)) {
-                    agregar_byte(static_cast<uint8_t>(immediate)); // imm8
+    dependencias.push_back({canonica, hash});
+    dependencias.insert(dependencias.end(), modulo->dependencias.begin(), modulo->dependencias.end());
+    enlazar_codificado(modulo->fragmento);
+}
+
+// -----------------------------------------------------------------------------
+// 🗂️ Secciones y datos
+// -----------------------------------------------------------------------------
+
+namespace {
+    // .text, .data (o .rodata) y .bss, sin distinguir mayúsculas; sólo cuenta
+    // el nombre, no los atributos que lo sigan
+    bool seccion_por_nombre(string_view operandos, SeccionELF& seccion) {
+        size_t fin = 0;
+        while (fin < operandos.size() && !es_espacio(operandos[fin])) ++fin;
+        const string_view nombre = operandos.substr(0, fin);
+        if (igual_sin_mayusculas(nombre, ".text")) seccion = SeccionELF::TEXTO;
+        else if (igual_sin_mayusculas(nombre, ".data") || igual_sin_mayusculas(nombre, ".rodata")) seccion = SeccionELF::DATOS;
+        else if (igual_sin_mayusculas(nombre, ".bss")) seccion = SeccionELF::BSS;
+        else return false;
+        return true;
+    }
+
+    // Fin del elemento de una lista separada por comas que empieza en
+    // 'inicio' (las comas entre comillas no cuentan)
+    size_t fin_elemento(string_view lista, size_t inicio) {
+        char comilla = 0;
+        for (size_t i = inicio; i < lista.size(); ++i) {
+            const char c = lista[i];
+            if (comilla) {
+                if (c == comilla) comilla = 0;
+            } else if (c == '\'' || c == '"') {
+                comilla = c;
+            } else if (c == ',') {
+                return i;
+            }
+        }
+        return lista.size();
+    }
+}
+
+bool EnsambladorIA32::seccion_de_linea(const LineaEscaneada& linea, SeccionELF& seccion) {
+    if (buscar_mnemonico(linea.texto.data(), linea.fin_token) != Mnemonico::SECTION) return false;
+    return seccion_por_nombre(recortar(linea.texto.substr(linea.fin_token)), seccion);
+}
+
+void EnsambladorIA32::seleccionar_seccion(SeccionELF seccion) {
+    // El contenido de la sección activa vive en los miembros de siempre
+    // (codigo_hex, contador_posicion...); el de las demás, en su hueco
+    if (seccion == seccion_actual) return;
+    vaciar_ventana();
+    ContenidoSeccion& actual = secciones[static_cast<int>(seccion_actual)];
+    actual.codigo.swap(codigo_hex);
+    actual.posicion = contador_posicion;
+    actual.referencias.swap(referencias_pendientes);
+    actual.saltos.swap(saltos_relajables);
+
+    ContenidoSeccion& nueva = secciones[static_cast<int>(seccion)];
+    codigo_hex.swap(nueva.codigo);
+    contador_posicion = nueva.posicion;
+    referencias_pendientes.swap(nueva.referencias);
+    saltos_relajables.swap(nueva.saltos);
+    nueva.posicion = 0;
+    seccion_actual = seccion;
+}
+
+void EnsambladorIA32::procesar_seccion(string_view operandos) {
+    SeccionELF seccion;
+    if (!seccion_por_nombre(recortar(operandos), seccion)) {
+        *diagnosticos << "Advertencia: Sección no soportada (se sigue en la actual): " << operandos << endl;
+        return;
+    }
+    seleccionar_seccion(seccion);
+}
+
+bool EnsambladorIA32::datos_en_bss(Mnemonico directiva) {
+    // .bss no tiene contenido en el archivo: sólo admite RESB/RESW/RESD
+    if (seccion_actual != SeccionELF::BSS) return false;
+    *diagnosticos << "Error: " << nombre_mnemonico(directiva) << " en .bss (sólo se admite RESB/RESW/RESD)" << endl;
+    return true;
+}
+
+void EnsambladorIA32::procesar_datos(Mnemonico directiva, string_view operandos) {
+    // DB / DW / DD: números, cadenas ('...' o "...", completadas con ceros
+    // hasta el tamaño del elemento) y, con DD, direcciones de etiqueta
+    if (datos_en_bss(directiva)) return;
+    const int tamano = directiva == Mnemonico::DB ? 1 : directiva == Mnemonico::DW ? 2 : 4;
+    if (operandos.empty()) {
+        *diagnosticos << "Error: " << nombre_mnemonico(directiva) << " sin datos" << endl;
+        return;
+    }
+
+    // Dos pasadas: la primera sólo valida, para que un elemento inválido no
+    // deje la directiva a medio emitir; la segunda emite
+    const int64_t maximo = (int64_t(1) << (8 * tamano)) - 1;
+    const int64_t minimo = -(int64_t(1) << (8 * tamano - 1));
+    for (int pasada = 0; pasada < 2; ++pasada) {
+        const bool emitir = pasada == 1;
+        size_t inicio = 0;
+        while (true) {
+            const size_t fin = fin_elemento(operandos, inicio);
+            const string_view elemento = recortar(operandos.substr(inicio, fin - inicio));
+            int64_t valor = 0;
+            string_view simbolo;
+            int64_t sumando = 0;
+            if (elemento.size() >= 2 && (elemento.front() == '\'' || elemento.front() == '"') &&
+                elemento.back() == elemento.front()) {
+                if (emitir) {
+                    const string_view cadena = elemento.substr(1, elemento.size() - 2);
+                    agregar_bloque(reinterpret_cast<const uint8_t*>(cadena.data()), cadena.size());
+                    const size_t sobrante = cadena.size() % tamano;
+                    if (sobrante != 0) {
+                        codigo_hex.resize(codigo_hex.size() + tamano - sobrante, 0);
+                        contador_posicion += static_cast<int>(tamano - sobrante);
+                    }
+                }
+            } else if (analizar_inmediato(elemento, valor)) {
+                if (valor < minimo || valor > maximo) {
+                    *diagnosticos << "Error: Valor fuera de rango en " << nombre_mnemonico(directiva) << ": " << elemento << endl;
                     return;
                 }
+                if (emitir) {
+                    if (tamano == 1) agregar_byte(static_cast<uint8_t>(valor));
+                    else if (tamano == 2) agregar_word(static_cast<uint16_t>(valor));
+                    else agregar_dword(static_cast<uint32_t>(valor));
+                }
+            } else if (tamano == 4 && analizar_simbolo(elemento, simbolo, sumando)) {
+                // Dirección absoluta: se parchea al resolver (o se reubica en el ELF)
+                if (emitir) {
+                    registrar_referencia(simbolo, 4, 0, static_cast<int32_t>(sumando));
+                    agregar_dword(0);
+                }
+            } else {
+                *diagnosticos << "Error: Dato inválido en " << nombre_mnemonico(directiva) << ": '" << elemento << "'" << endl;
+                return;
             }
-        } catch (...) {
-            cerr << "Error: Inmediato inválido en SUB memoria: " << src_str << endl;
-            return;
+            if (fin == operandos.size()) break;
+            inicio = fin + 1;
         }
     }
-
-    cerr << "Error de sintaxis o modo no soportado para SUB: " << operandos << endl;
 }
 
-void EnsambladorIA32::procesar_jmp(string operandos) {
-    // JMP near (32-bit relativo)
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
+void EnsambladorIA32::procesar_reserva(Mnemonico directiva, string_view operandos) {
+    // RESB / RESW / RESD n: en .bss sólo avanza el contador; en .text y .data
+    // el espacio se rellena con ceros de una vez
+    const int64_t tamano = directiva == Mnemonico::RESB ? 1 : directiva == Mnemonico::RESW ? 2 : 4;
+    int64_t cuenta = 0;
+    if (!analizar_inmediato(recortar(operandos), cuenta) || cuenta < 0) {
+        *diagnosticos << "Error: " << nombre_mnemonico(directiva) << " necesita un número de elementos: " << operandos << endl;
+        return;
+    }
+    const int64_t bytes = cuenta * tamano;
+    if (bytes > INT_MAX - contador_posicion) {
+        *diagnosticos << "Error: La sección pasaría de 2 GiB: " << operandos << endl;
+        return;
+    }
+    if (seccion_actual != SeccionELF::BSS) codigo_hex.resize(codigo_hex.size() + bytes, 0);
+    contador_posicion += static_cast<int>(bytes);
+}
 
-    agregar_byte(0xE9); // Opcode E9 
-    
-    int tamano_instruccion = 5; // E9 (1 byte) + desplazamiento (4 bytes)
-    int posicion_referencia = contador_posicion;
-    contador_posicion += 4; // Avanzar el contador para el desplazamiento
+void EnsambladorIA32::procesar_times(string_view operandos) {
+    /*
+        TIMES n INSTRUCCIÓN: se procesa una vez y, si el resultado no depende
+        de su posición (sin referencias, saltos ni ALIGN), el resto de copias
+        se hace en bloque, duplicando lo ya copiado (log2(n) memcpy). Si no,
+        la línea se procesa n veces.
+    */
+    size_t fin = 0;
+    while (fin < operandos.size() && !es_espacio(operandos[fin])) ++fin;
+    const string_view linea = recortar(operandos.substr(fin));
+    int64_t veces = 0;
+    if (!analizar_inmediato(operandos.substr(0, fin), veces) || veces < 0 || linea.empty()) {
+        *diagnosticos << "Error: TIMES necesita un número de repeticiones y una instrucción: " << operandos << endl;
+        return;
+    }
+    if (veces == 0) return;
+
+    size_t fin_mnemonico = 0;
+    while (fin_mnemonico < linea.size() && !es_espacio(linea[fin_mnemonico])) ++fin_mnemonico;
+    const SeccionELF seccion = seccion_actual;
+    const size_t bytes_antes = codigo_hex.size();
+    const int posicion_antes = contador_posicion;
+    const size_t referencias_antes = referencias_pendientes.size();
+    const size_t saltos_antes = saltos_relajables.size();
+    const size_t instrucciones_antes = instrucciones_analisis.size();
+    procesar_instruccion(linea, fin_mnemonico);
+    vaciar_ventana();
+
+    const size_t bytes = codigo_hex.size() - bytes_antes;
+    const int avance = contador_posicion - posicion_antes;
+    const bool en_bloque = seccion_actual == seccion && referencias_pendientes.size() == referencias_antes &&
+                           saltos_relajables.size() == saltos_antes &&
+                           instrucciones_analisis.size() == instrucciones_antes &&
+                           (bytes == 0 || bytes == static_cast<size_t>(avance));
+    // Sin avance (ALIGN, SECTION, GLOBAL...) repetir la línea no añade nada:
+    // un ALIGN en la misma posición ya no rellena
+    if (avance <= 0) return;
+    if (veces - 1 > (INT_MAX - contador_posicion) / avance) {
+        *diagnosticos << "Error: La sección pasaría de 2 GiB: TIMES " << operandos << endl;
+        return;
+    }
+    if (!en_bloque) {
+        for (int64_t i = 1; i < veces; ++i) {
+            procesar_instruccion(linea, fin_mnemonico);
+            vaciar_ventana();
+        }
+        return;
+    }
+    if (bytes > 0) {
+        const size_t total = bytes * static_cast<size_t>(veces);
+        codigo_hex.resize(bytes_antes + total);
+        uint8_t* copia = codigo_hex.data() + bytes_antes;
+        for (size_t hechos = bytes; hechos < total; hechos *= 2) {
+            memcpy(copia + hechos, copia, min(hechos, total - hechos));
+        }
+    }
+    contador_posicion = posicion_antes + avance * static_cast<int>(veces);
+}
 
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-        int offset = destino - (contador_posicion);
-        agregar_dword(static_cast<uint32_t>(offset));
+void EnsambladorIA32::incluir_binario(string_view operandos) {
+    // INCBIN "archivo"[, desde[, bytes]]: el archivo se proyecta en memoria y
+    // se copia de una vez; cuenta como dependencia (cachés y --watch)
+    if (datos_en_bss(Mnemonico::INCBIN)) return;
+    string_view resto = recortar(operandos);
+    string_view nombre;
+    bool correcto = true;
+    if (!resto.empty() && (resto.front() == '"' || resto.front() == '\'')) {
+        const size_t cierre = resto.find(resto.front(), 1);
+        correcto = cierre != string_view::npos;
+        if (correcto) {
+            nombre = resto.substr(1, cierre - 1);
+            resto = recortar(resto.substr(cierre + 1));
+        }
     } else {
-        ReferenciaPendiente ref;
-        ref.posicion = posicion_referencia;
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto = 1; // Relativo
-        referencias_pendientes[etiqueta].push_back(ref);
-        agregar_dword(0); // Se parcheará después
-    }
-}
-
-void EnsambladorIA32::procesar_condicional(const string& mnem, string operandos) {
-    // Se asume el salto largo (near, 32-bit relativo)
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-    
-    uint8_t opcode_byte1 = 0x0F;
-    uint8_t opcode_byte2;
-
-    // Mapeo de mnemónicos condicionales a su segundo byte de opcode
-    if (mnem == "JE" || mnem == "JZ") opcode_byte2 = 0x84;
-    else if (mnem == "JNE" || mnem == "JNZ") opcode_byte2 = 0x85;
-    else if (mnem == "JLE") opcode_byte2 = 0x8E;
-    else if (mnem == "JL") opcode_byte2 = 0x8C;
-    else if (mnem == "JA") opcode_byte2 = 0x87;
-    else if (mnem == "JAE") opcode_byte2 = 0x83;
-    else if (mnem == "JB") opcode_byte2 = 0x82;
-    else if (mnem == "JBE") opcode_byte2 = 0x86;
-    else if (mnem == "JG") opcode_byte2 = 0x8F;
-    else if (mnem == "JGE") opcode_byte2 = 0x8D;
-    else {
-        cerr << "Error: Mnemónico condicional no soportado: " << mnem << endl;
+        const size_t coma = resto.find(',');
+        nombre = recortar(resto.substr(0, coma));
+        resto = coma == string_view::npos ? string_view() : resto.substr(coma);
+    }
+
+    int64_t desde = 0, longitud = -1;
+    correcto = correcto && !nombre.empty();
+    if (correcto && !resto.empty()) {
+        correcto = resto.front() == ',';
+        resto = resto.substr(1);
+        const size_t coma = resto.find(',');
+        correcto = correcto && analizar_inmediato(recortar(resto.substr(0, coma)), desde) && desde >= 0;
+        if (correcto && coma != string_view::npos) {
+            correcto = analizar_inmediato(recortar(resto.substr(coma + 1)), longitud) && longitud >= 0;
+        }
+    }
+    if (!correcto) {
+        *diagnosticos << "Error: INCBIN necesita un archivo (y, opcionalmente, desplazamiento y longitud): "
+                      << operandos << endl;
         return;
     }
 
-    agregar_byte(opcode_byte1);
-    agregar_byte(opcode_byte2);
+    string ruta(nombre);
+    if (ruta[0] != '/' && !directorio_fuente.empty()) ruta = directorio_fuente + "/" + ruta;
+    LectorFuente lector;
+    if (!lector.abrir(ruta)) {
+        *diagnosticos << "Error: No se pudo abrir el archivo de INCBIN: " << ruta << endl;
+        return;
+    }
+    const string_view contenido = lector.contenido();
+    dependencias.push_back({ruta_canonica(ruta), hash_contenido(contenido)});
+
+    const size_t inicio = min<size_t>(static_cast<size_t>(desde), contenido.size());
+    size_t bytes = contenido.size() - inicio;
+    if (longitud >= 0) bytes = min<size_t>(bytes, static_cast<size_t>(longitud));
+    if (bytes > static_cast<size_t>(INT_MAX - contador_posicion)) {
+        *diagnosticos << "Error: La sección pasaría de 2 GiB: INCBIN " << ruta << endl;
+        return;
+    }
+    agregar_bloque(reinterpret_cast<const uint8_t*>(contenido.data()) + inicio, bytes);
+}
 
-    int tamano_instruccion = 6; // 0F 8X + desplazamiento (4 bytes)
-    int posicion_referencia = contador_posicion;
-    contador_posicion += 4;
+void EnsambladorIA32::alinear_seccion(SeccionELF seccion) {
+    /*
+        ALIGN en .data y .bss: el relleno depende de dónde acabe cada parte de
+        la sección tras enlazar los fragmentos, así que se anota y se aplica
+        aquí, con ceros (en .bss sólo crece el tamaño). Como en .text, las
+        etiquetas en la posición de un ALIGN quedan detrás de su relleno.
+    */
+    ContenidoSeccion& contenido = secciones[static_cast<int>(seccion)];
+    vector<SaltoRelajable>& puntos = contenido.saltos;
+    if (puntos.empty()) return;
+
+    vector<int>& relleno_antes = crecimiento_acumulado;
+    relleno_antes.assign(puntos.size() + 1, 0);
+    for (size_t i = 0; i < puntos.size(); ++i) {
+        SaltoRelajable& punto = puntos[i];
+        const int relleno = -(punto.posicion + relleno_antes[i]) & (punto.alineacion - 1);
+        punto.relleno = relleno <= punto.relleno_maximo ? static_cast<uint16_t>(relleno) : 0;
+        relleno_antes[i + 1] = relleno_antes[i] + punto.relleno;
+        alineacion_datos = max(alineacion_datos, punto.alineacion);
+    }
+    auto relleno_hasta = [&](int posicion) {
+        auto it = upper_bound(puntos.begin(), puntos.end(), posicion,
+                              [](int p, const SaltoRelajable& punto) { return p < punto.posicion; });
+        return relleno_antes[it - puntos.begin()];
+    };
 
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-        int offset = destino - contador_posicion;
-        agregar_dword(static_cast<uint32_t>(offset));
-    } else {
-        ReferenciaPendiente ref;
-        ref.posicion = posicion_referencia;
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto = 1; // Relativo
-        referencias_pendientes[etiqueta].push_back(ref);
-        agregar_dword(0);
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (secciones_simbolos[id] == seccion && tabla_simbolos[id] != SIN_DEFINIR) {
+            tabla_simbolos[id] += relleno_hasta(tabla_simbolos[id]);
+        }
+    }
+    for (ReferenciaPendiente& ref : contenido.referencias) {
+        ref.posicion += static_cast<uint32_t>(relleno_hasta(static_cast<int>(ref.posicion)));
     }
+
+    if (seccion != SeccionELF::BSS) {
+        vector<uint8_t>& nuevo = codigo_relajado;
+        nuevo.clear();
+        nuevo.reserve(contenido.codigo.size() + relleno_antes.back());
+        int anterior = 0;
+        for (const SaltoRelajable& punto : puntos) {
+            nuevo.insert(nuevo.end(), contenido.codigo.begin() + anterior, contenido.codigo.begin() + punto.posicion);
+            nuevo.resize(nuevo.size() + punto.relleno, 0);
+            anterior = punto.posicion;
+        }
+        nuevo.insert(nuevo.end(), contenido.codigo.begin() + anterior, contenido.codigo.end());
+        contenido.codigo.swap(nuevo);
+    }
+    contenido.posicion += relleno_antes.back();
+    puntos.clear();
+}
+
+int EnsambladorIA32::tamano_seccion(SeccionELF seccion) const {
+    return seccion == seccion_actual ? contador_posicion : secciones[static_cast<int>(seccion)].posicion;
+}
+
+uint32_t EnsambladorIA32::base_seccion(SeccionELF seccion) const {
+    // En la imagen plana .data va tras .text y .bss tras .data, alineadas
+    if (seccion == SeccionELF::TEXTO) return 0;
+    auto alinear = [&](uint32_t valor) { return (valor + alineacion_datos - 1) & ~(alineacion_datos - 1u); };
+    const uint32_t base_datos = alinear(static_cast<uint32_t>(tamano_seccion(SeccionELF::TEXTO)));
+    if (seccion == SeccionELF::DATOS) return base_datos;
+    return alinear(base_datos + static_cast<uint32_t>(tamano_seccion(SeccionELF::DATOS)));
 }
 
 // -----------------------------------------------------------------------------
-// 🧩 Resolución de referencias pendientes
+// 🧾 Análisis de operandos y selección de forma
 // -----------------------------------------------------------------------------
 
-void EnsambladorIA32::resolver_referencias_pendientes() {
-    for (auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        auto& lista_refs = par.second;
+bool EnsambladorIA32::analizar_inmediato(string_view texto, int64_t& valor) {
+    // Formatos: decimal (10), hexadecimal (0x0A / 0AH), con signo opcional
+    if (texto.empty()) return false;
 
-        if (!tabla_simbolos.count(etiqueta)) {
-            cerr << "Advertencia: Etiqueta no definida '" << etiqueta << "'. Referencia no resuelta." << endl;
-            continue;
-        }
+    bool negativo = false;
+    if (texto[0] == '-' || texto[0] == '+') {
+        negativo = texto[0] == '-';
+        texto.remove_prefix(1);
+    }
+    if (texto.empty() || texto[0] < '0' || texto[0] > '9') return false;
+
+    unsigned base = 10;
+    if (texto.size() > 2 && texto[0] == '0' && a_mayuscula(texto[1]) == 'X') {
+        texto.remove_prefix(2);
+        base = 16;
+    } else if (texto.size() > 1 && a_mayuscula(texto.back()) == 'H') {
+        texto.remove_suffix(1);
+        base = 16;
+    }
+
+    uint64_t v = 0;
+    for (char c : texto) {
+        char m = a_mayuscula(c);
+        unsigned d;
+        if (m >= '0' && m <= '9') d = static_cast<unsigned>(m - '0');
+        else if (m >= 'A' && m <= 'F') d = static_cast<unsigned>(m - 'A' + 10);
+        else return false;
+        if (d >= base) return false;
+        v = v * base + d;
+        if (v > 0xFFFFFFFFull) return false;
+    }
+
+    valor = negativo ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+    return true;
+}
 
-        int destino = tabla_simbolos[etiqueta];
+namespace {
+    // Un nombre de etiqueta no empieza por un dígito (sería un número mal
+    // formado o fuera de rango), '[' (memoria sin cerrar) ni comillas
+    bool puede_ser_simbolo(string_view nombre) {
+        if (nombre.empty()) return false;
+        const char c = nombre.front();
+        return !(c >= '0' && c <= '9') && c != '[' && c != '\'' && c != '"';
+    }
+}
 
-        for (auto& ref : lista_refs) {
-            int pos = ref.posicion;
-            uint32_t valor_a_parchear;
+bool EnsambladorIA32::analizar_simbolo(string_view texto, string_view& simbolo, int64_t& sumando) {
+    // Formatos: ETIQUETA, ETIQUETA+DISP, ETIQUETA-DISP
+    size_t signo = texto.find_first_of("+-", 1);
+    simbolo = recortar(texto.substr(0, signo));
+    sumando = 0;
+    if (!puede_ser_simbolo(simbolo)) return false;
+    if (signo == string_view::npos) return true;
+
+    string_view resto = texto.substr(signo);
+    size_t ini = 1;
+    while (ini < resto.size() && es_espacio(resto[ini])) ++ini;
+    if (ini >= resto.size() || resto[ini] == '+' || resto[ini] == '-') return false;
+
+    int64_t disp;
+    if (!analizar_inmediato(recortar(resto.substr(ini)), disp)) return false;
+    sumando = resto[0] == '-' ? -disp : disp;
+    return true;
+}
 
-            if (ref.tipo_salto == 0) {
-                // Salto absoluto
-                valor_a_parchear = destino;
+bool EnsambladorIA32::analizar_memoria(string_view interior, Operando& op) {
+    // Términos separados por '+' / '-' en cualquier orden: registros (el
+    // primero es la base, el segundo el índice), REG*ESCALA o ESCALA*REG,
+    // números (se suman al desplazamiento) y como mucho una etiqueta
+    size_t i = 0;
+    while (i < interior.size()) {
+        bool negativo = false;
+        while (i < interior.size() && (interior[i] == '+' || interior[i] == '-' || es_espacio(interior[i]))) {
+            if (interior[i] == '-') negativo = !negativo;
+            ++i;
+        }
+        size_t fin = interior.find_first_of("+-", i);
+        if (fin == string_view::npos) fin = interior.size();
+        string_view termino = recortar(interior.substr(i, fin - i));
+        i = fin;
+        if (termino.empty()) return false;
+
+        uint8_t reg;
+        size_t por = termino.find('*');
+        if (por != string_view::npos) {
+            string_view a = recortar(termino.substr(0, por));
+            string_view b = recortar(termino.substr(por + 1));
+            int64_t escala;
+            if (!obtener_reg32(a, reg)) swap(a, b);
+            if (negativo || !obtener_reg32(a, reg) || !analizar_inmediato(b, escala)) return false;
+            if (escala != 1 && escala != 2 && escala != 4 && escala != 8) return false;
+            if (op.indice != Operando::SIN_REGISTRO) return false;
+            op.indice = reg;
+            op.escala = static_cast<uint8_t>(escala);
+        } else if (obtener_reg32(termino, reg)) {
+            if (negativo) return false;
+            if (op.base == Operando::SIN_REGISTRO) op.base = reg;
+            else if (op.indice == Operando::SIN_REGISTRO) op.indice = reg;
+            else return false;
+        } else {
+            int64_t numero;
+            if (analizar_inmediato(termino, numero)) {
+                op.valor += negativo ? -numero : numero;
             } else {
-                // Salto relativo
-                int offset = destino - (pos + ref.tamano_inmediato);
-                valor_a_parchear = static_cast<uint32_t>(offset);
+                if (negativo || !op.simbolo.empty() || !puede_ser_simbolo(termino)) return false;
+                op.simbolo = termino;
             }
+        }
+    }
 
-            // Escribir el valor en codigo_hex (little-endian)
-            if (pos + 3 < static_cast<int>(codigo_hex.size())) {
-                codigo_hex[pos]     = static_cast<uint8_t>(valor_a_parchear & 0xFF);
-                codigo_hex[pos + 1] = static_cast<uint8_t>((valor_a_parchear >> 8) & 0xFF);
-                codigo_hex[pos + 2] = static_cast<uint8_t>((valor_a_parchear >> 16) & 0xFF);
-                codigo_hex[pos + 3] = static_cast<uint8_t>((valor_a_parchear >> 24) & 0xFF);
-            } else {
-                cerr << "Error: Referencia fuera de rango al parchear." << endl;
-            }
+    // ESP sólo puede ir de índice con escala 1 y otra base (se intercambian
+    // al codificar): se rechaza aquí, antes de emitir ningún byte
+    if (op.indice == 4 && (op.escala != 1 || op.base == 4)) return false;
+    return true;
+}
+
+bool EnsambladorIA32::analizar_operando(string_view texto, Operando& op) {
+    limpiar_linea(texto);
+    if (texto.empty()) return false;
+
+    op = Operando();
+
+    // Prefijo de tamaño opcional: BYTE [X], DWORD [X], DWORD PTR [X], OWORD [X]
+    size_t fin_palabra = 0;
+    while (fin_palabra < texto.size() && !es_espacio(texto[fin_palabra]) && texto[fin_palabra] != '[') ++fin_palabra;
+    string_view palabra = texto.substr(0, fin_palabra);
+    if (igual_sin_mayusculas(palabra, "BYTE")) op.tamano = 1;
+    else if (igual_sin_mayusculas(palabra, "DWORD")) op.tamano = 4;
+    else if (igual_sin_mayusculas(palabra, "OWORD") || igual_sin_mayusculas(palabra, "XMMWORD")) op.tamano = 16;
+    if (op.tamano) {
+        texto = recortar(texto.substr(fin_palabra));
+        if (texto.size() > 3 && igual_sin_mayusculas(texto.substr(0, 3), "PTR") && !isalnum(static_cast<unsigned char>(texto[3]))) {
+            texto = recortar(texto.substr(3));
+        }
+    }
+
+    // Memoria: [BASE + INDICE*ESCALA + DESPLAZAMIENTO]
+    if (texto.size() > 2 && texto.front() == '[' && texto.back() == ']') {
+        string_view interior = recortar(texto.substr(1, texto.size() - 2));
+        if (interior.empty()) return false;
+
+        op.tipo = TipoOperando::MEMORIA;
+        return analizar_memoria(interior, op);
+    }
+    if (op.tamano) return false; // El prefijo de tamaño sólo aplica a memoria
+
+    if (obtener_reg32(texto, op.reg)) {
+        op.tipo = TipoOperando::REG32;
+        return true;
+    }
+    if (obtener_reg8(texto, op.reg)) {
+        op.tipo = TipoOperando::REG8;
+        return true;
+    }
+    if (obtener_xmm(texto, op.reg)) {
+        op.tipo = TipoOperando::XMM;
+        return true;
+    }
+    if (analizar_inmediato(texto, op.valor)) {
+        op.tipo = TipoOperando::INMEDIATO;
+        return true;
+    }
+
+    // Cualquier otra cosa es una etiqueta (con sumando opcional)
+    op.tipo = TipoOperando::ETIQUETA;
+    return analizar_simbolo(texto, op.simbolo, op.valor);
+}
+
+bool EnsambladorIA32::operando_encaja(const Operando& op, FormaOperando forma) {
+    bool es_mem = op.tipo == TipoOperando::MEMORIA;
+    bool es_num = op.tipo == TipoOperando::INMEDIATO;
+
+    switch (forma) {
+        case FormaOperando::NINGUNO: return op.tipo == TipoOperando::NINGUNO;
+        case FormaOperando::R8:      return op.tipo == TipoOperando::REG8;
+        case FormaOperando::R32:     return op.tipo == TipoOperando::REG32;
+        case FormaOperando::AL:      return op.tipo == TipoOperando::REG8 && op.reg == 0;
+        case FormaOperando::CL:      return op.tipo == TipoOperando::REG8 && op.reg == 1;
+        case FormaOperando::EAX:     return op.tipo == TipoOperando::REG32 && op.reg == 0;
+        case FormaOperando::RM8:     return op.tipo == TipoOperando::REG8 || (es_mem && op.tamano == 1);
+        case FormaOperando::RM32:    return op.tipo == TipoOperando::REG32 || (es_mem && (op.tamano == 0 || op.tamano == 4));
+        case FormaOperando::MEM:     return es_mem;
+        case FormaOperando::MOFFS8:
+        case FormaOperando::MOFFS32: {
+            bool directa = es_mem && op.base == Operando::SIN_REGISTRO && op.indice == Operando::SIN_REGISTRO;
+            return directa && (forma == FormaOperando::MOFFS8 ? op.tamano == 1 : (op.tamano == 0 || op.tamano == 4));
+        }
+        case FormaOperando::IMM8: {
+            // Sólo la usan formas de destino de 32 bits (83, 6A, 6B): 0xFFFFFFF0
+            // es -16 tras truncar a 32 bits y cabe en un byte con signo
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(op.valor));
+            return es_num && v >= -128 && v <= 127;
         }
+        case FormaOperando::IMM8U:   return es_num && op.valor >= -128 && op.valor <= 255;
+        case FormaOperando::IMM16:   return es_num && op.valor >= -32768 && op.valor <= 65535;
+        case FormaOperando::IMM32:   return es_num || op.tipo == TipoOperando::ETIQUETA;
+        case FormaOperando::UNO:     return es_num && op.valor == 1;
+        case FormaOperando::REL:     return op.tipo == TipoOperando::ETIQUETA;
+        case FormaOperando::XMM:     return op.tipo == TipoOperando::XMM;
+        case FormaOperando::XMMM128: return op.tipo == TipoOperando::XMM || (es_mem && (op.tamano == 0 || op.tamano == 16));
     }
+    return false;
+}
+
+const FormaInstruccion* EnsambladorIA32::buscar_forma(Mnemonico mnem, const Operando* ops, int total_ops) {
+    // Primera forma del mnemónico cuyos operandos encajan (la tabla está ordenada
+    // de la codificación más corta a la más larga)
+    const RangoFormas& rango = INDICE_FORMAS.rango[static_cast<size_t>(mnem)];
+    for (size_t i = rango.inicio; i < size_t(rango.inicio) + rango.cantidad; ++i) {
+        const FormaInstruccion& forma = TABLA_FORMAS[i];
+        bool encaja = true;
+        for (int k = 0; k < 3 && encaja; ++k) {
+            Operando vacio;
+            encaja = operando_encaja(k < total_ops ? ops[k] : vacio, forma.op[k]);
+        }
+        if (encaja) return &forma;
+    }
+    return nullptr;
 }
 
 // -----------------------------------------------------------------------------
-// 🏗️ Proceso de ensamblado principal
+// 🧾 Codificación de instrucciones
 // -----------------------------------------------------------------------------
 
-void EnsambladorIA32::ensamblar(const string& archivo_entrada) {
-    ifstream f(archivo_entrada);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+void EnsambladorIA32::codificar(const FormaInstruccion& forma, const Operando* ops) {
+    if (forma.codificacion == Codificacion::RELATIVO) {
+        if (forma.mnem == Mnemonico::JMP) {
+            procesar_jmp(ops[0].simbolo, static_cast<int32_t>(ops[0].valor));
+        } else if (es_salto_condicional(forma.mnem)) {
+            procesar_condicional(forma.opcode, ops[0].simbolo, static_cast<int32_t>(ops[0].valor));
+        } else {
+            // CALL rel32
+            agregar_byte(forma.opcode);
+            registrar_referencia(ops[0].simbolo, 4, 1, static_cast<int32_t>(ops[0].valor)); // Relativo
+            agregar_dword(0);
+        }
         return;
     }
 
-    string linea;
-    while (getline(f, linea)) {
-        procesar_linea(linea);
+    // Prefijo obligatorio y escapes: [66/F2/F3] 0F [38] opcode
+    if (forma.prefijo) agregar_byte(forma.prefijo);
+    if (forma.escape_0f) agregar_byte(0x0F);
+    if (forma.escape_secundario) agregar_byte(forma.escape_secundario);
+
+    switch (forma.codificacion) {
+        case Codificacion::SOLO_OPCODE:
+            agregar_byte(forma.opcode);
+            break;
+
+        case Codificacion::REG_EN_OPCODE: {
+            // opcode+rd; el registro es el primer operando salvo en XCHG EAX, r32
+            int idx = (forma.op[0] == FormaOperando::R32 || forma.op[0] == FormaOperando::R8) ? 0 : 1;
+            agregar_byte(forma.opcode + ops[idx].reg);
+            break;
+        }
+
+        case Codificacion::DIRECCION: {
+            // A0-A3: opcode seguido directamente de la dirección de 32 bits
+            int idx_mem = ops[0].tipo == TipoOperando::MEMORIA ? 0 : 1;
+            agregar_byte(forma.opcode);
+            agregar_desplazamiento(ops[idx_mem], 4);
+            break;
+        }
+
+        case Codificacion::MODRM: {
+            // El operando r/m es el que admite memoria; el otro registro (si lo
+            // hay) va al campo reg, salvo que la forma use una extensión /n
+            int idx_rm = -1, idx_reg = -1;
+            for (int k = 0; k < 3; ++k) {
+                FormaOperando f = forma.op[k];
+                if (f == FormaOperando::RM8 || f == FormaOperando::RM32 || f == FormaOperando::MEM ||
+                    f == FormaOperando::XMMM128) idx_rm = k;
+                else if (f == FormaOperando::R8 || f == FormaOperando::R32 || f == FormaOperando::XMM) idx_reg = k;
+            }
+
+            uint8_t reg_field = forma.extension >= 0 ? static_cast<uint8_t>(forma.extension)
+                                                     : ops[idx_reg].reg;
+            agregar_byte(forma.opcode);
+            if (ops[idx_rm].tipo == TipoOperando::MEMORIA) {
+                codificar_memoria(ops[idx_rm], reg_field);
+            } else {
+                agregar_byte(generar_modrm(0b11, reg_field, ops[idx_rm].reg)); // Mod=11 (Reg-Reg)
+            }
+            break;
+        }
+
+        case Codificacion::RELATIVO:
+            break;
     }
 
-    f.close();
+    // Inmediatos, en el orden de los operandos
+    for (int k = 0; k < 3; ++k) {
+        switch (forma.op[k]) {
+            case FormaOperando::IMM8:
+            case FormaOperando::IMM8U: agregar_inmediato(ops[k], 1); break;
+            case FormaOperando::IMM16: agregar_inmediato(ops[k], 2); break;
+            case FormaOperando::IMM32: agregar_inmediato(ops[k], 4); break;
+            default: break;
+        }
+    }
 }
 
-void EnsambladorIA32::generar_hex(const string& archivo_salida) {
-    ofstream f(archivo_salida);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+void EnsambladorIA32::procesar_jmp(string_view etiqueta, int32_t sumando) {
+    // JMP: se emite la forma corta (EB rel8) y relajar_saltos() la alarga a
+    // E9 rel32 sólo si el destino queda fuera de rango
+    if (salida_continua) {
+        emitir_salto_continuo(false, 0, etiqueta, sumando);
         return;
     }
+    SaltoRelajable salto;
+    salto.posicion = contador_posicion;
+    salto.condicional = false;
+    salto.condicion = 0;
+    salto.largo = false;
+    salto.eliminado = false;
+    salto.destino = -1;
+    salto.simbolo = id_simbolo(etiqueta);
+    salto.sumando = sumando;
+    salto.alineacion = 0;
+    salto.relleno_maximo = 0;
+    salto.relleno = 0;
+    saltos_relajables.push_back(salto);
+
+    agregar_byte(0xEB);
+    agregar_byte(0x00); // Se parcheará después
+}
 
-    f << hex << uppercase << setfill('0');
-    for (uint8_t byte : codigo_hex) {
-        f << setw(2) << static_cast<int>(byte) << " ";
+void EnsambladorIA32::procesar_condicional(uint8_t opcode_byte2, string_view etiqueta, int32_t sumando) {
+    // Jcc: el segundo byte del opcode largo (0F 8x) viene de la tabla de formas;
+    // se emite la forma corta (7x rel8) y relajar_saltos() decide el tamaño final
+    if (salida_continua) {
+        emitir_salto_continuo(true, opcode_byte2 & 0x0F, etiqueta, sumando);
+        return;
     }
-    f << endl;
-    f.close();
+    SaltoRelajable salto;
+    salto.posicion = contador_posicion;
+    salto.condicional = true;
+    salto.condicion = opcode_byte2 & 0x0F;
+    salto.largo = false;
+    salto.eliminado = false;
+    salto.destino = -1;
+    salto.simbolo = id_simbolo(etiqueta);
+    salto.sumando = sumando;
+    salto.alineacion = 0;
+    salto.relleno_maximo = 0;
+    salto.relleno = 0;
+    saltos_relajables.push_back(salto);
+
+    agregar_byte(0x70 | salto.condicion);
+    agregar_byte(0x00);
 }
 
-void EnsambladorIA32::generar_reportes() {
-    // Generar Tabla de Símbolos
-    ofstream sym("simbolos.txt");
-    sym << "Tabla de Símbolos:" << endl;
-    for (const auto& par : tabla_simbolos) {
-        sym << par.first << " -> " << par.second << endl;
+// -----------------------------------------------------------------------------
+// 🪢 Relajación de saltos (rel8 -> rel32)
+// -----------------------------------------------------------------------------
+
+namespace {
+    // NOPs de varios bytes recomendados por Intel (0F 1F /0 con prefijo 66 y
+    // desplazamientos de relleno): una sola instrucción por cada 9 bytes
+    constexpr uint8_t NOPS[9][9] = {
+        {0x90},
+        {0x66, 0x90},
+        {0x0F, 0x1F, 0x00},
+        {0x0F, 0x1F, 0x40, 0x00},
+        {0x0F, 0x1F, 0x44, 0x00, 0x00},
+        {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00},
+        {0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00},
+        {0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+        {0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00}
+    };
+
+    void agregar_nops(vector<uint8_t>& codigo, size_t bytes) {
+        while (bytes > 0) {
+            const size_t n = min<size_t>(bytes, 9);
+            codigo.insert(codigo.end(), NOPS[n - 1], NOPS[n - 1] + n);
+            bytes -= n;
+        }
     }
-    sym.close();
+}
+
+int EnsambladorIA32::crecimiento_antes(int posicion) {
+    // Bytes añadidos por los saltos alargados que empiezan antes de 'posicion'
+    // (un salto que empieza justo en 'posicion' va detrás de esa dirección; un
+    // ALIGN en 'posicion', delante: las etiquetas quedan tras el relleno)
+    auto it = lower_bound(saltos_relajables.begin(), saltos_relajables.end(), posicion,
+                          [](const SaltoRelajable& s, int p) {
+                              return s.posicion < p || (s.posicion == p && s.alineacion != 0);
+                          });
+    return crecimiento_acumulado[it - saltos_relajables.begin()];
+}
+
+void EnsambladorIA32::marcar_cabeceras_bucle() {
+    // Cabecera de bucle: etiqueta destino de un salto hacia atrás. Se le pone
+    // un ALIGN implícito, ordenado delante de lo que empiece en su posición
+    vector<int> cabeceras;
+    for (const SaltoRelajable& s : saltos_relajables) {
+        if (s.alineacion) continue;
+        const int destino = posicion_texto(s.simbolo);
+        if (destino != SIN_DEFINIR && s.sumando == 0 && destino <= s.posicion) cabeceras.push_back(destino);
+    }
+    if (cabeceras.empty()) return;
+    sort(cabeceras.begin(), cabeceras.end());
+    cabeceras.erase(unique(cabeceras.begin(), cabeceras.end()), cabeceras.end());
+
+    const uint16_t alineacion = alineacion_bucles.alineacion;
+    const uint16_t maximo = min<uint16_t>(alineacion_bucles.relleno_maximo, alineacion - 1);
+    vector<SaltoRelajable> fusion;
+    fusion.reserve(saltos_relajables.size() + cabeceras.size());
+    size_t c = 0;
+    for (const SaltoRelajable& s : saltos_relajables) {
+        for (; c < cabeceras.size() && cabeceras[c] <= s.posicion; ++c) {
+            fusion.push_back(punto_alineacion(cabeceras[c], alineacion, maximo));
+        }
+        fusion.push_back(s);
+    }
+    saltos_relajables.swap(fusion);
+}
+
+void EnsambladorIA32::relajar_saltos() {
+    /*
+        Todos los saltos se emitieron en forma corta (2 bytes). Se alargan sólo
+        los que no alcanzan su destino con rel8, repitiendo hasta un punto fijo:
+        alargar un salto puede dejar fuera de rango a otro que lo atraviesa.
+        Los saltos sólo crecen, así que el proceso termina. El relleno de cada
+        ALIGN se recalcula en cada vuelta según dónde queda (puede crecer o
+        menguar); un salto alargado por un relleno que luego mengua se queda
+        largo, que sigue siendo correcto.
+    */
+    if (alineacion_bucles.alineacion > 1) marcar_cabeceras_bucle();
+    if (saltos_relajables.empty()) return;
+
+    const size_t total = saltos_relajables.size();
+    size_t eliminados = 0, saltos = 0;
+    for (auto& salto : saltos_relajables) {
+        if (salto.alineacion) {
+            alineacion_maxima = max(alineacion_maxima, salto.alineacion);
+            continue;
+        }
+        ++saltos;
+        salto.destino = posicion_texto(salto.simbolo);
+        salto.largo = salto.destino == SIN_DEFINIR; // Sin destino en .text: rel32 por seguridad
+        // Con -O, un salto a la instrucción que le sigue no hace nada: se quita
+        // (la etiqueta de destino pasa a la posición que ocupaba el salto)
+        salto.eliminado = optimizar && salto.sumando == 0 && salto.destino == salto.posicion + 2;
+        eliminados += salto.eliminado;
+    }
+    if (analizar && eliminados) {
+        vector<pair<int, int>> quitados;
+        for (const auto& salto : saltos_relajables) {
+            if (salto.eliminado) quitados.push_back({salto.posicion, salto.posicion + 2});
+        }
+        quitar_de_analisis(quitados, false);
+    }
+
+    // crecimiento_acumulado[i] = bytes extra de los saltos y rellenos [0, i)
+    crecimiento_acumulado.assign(total + 1, 0);
+    auto recalcular = [&]() {
+        for (size_t i = 0; i < total; ++i) {
+            SaltoRelajable& s = saltos_relajables[i];
+            int extra;
+            if (s.alineacion) {
+                const int relleno = -(s.posicion + crecimiento_acumulado[i]) & (s.alineacion - 1);
+                s.relleno = relleno <= s.relleno_maximo ? static_cast<uint16_t>(relleno) : 0;
+                extra = s.relleno;
+            } else {
+                extra = s.largo ? (s.condicional ? 4 : 3) : 0; // 0F 8x rel32 / E9 rel32
+                if (s.eliminado) extra = -2;
+            }
+            crecimiento_acumulado[i + 1] = crecimiento_acumulado[i] + extra;
+        }
+    };
+
+    bool hubo_cambios = true;
+    while (hubo_cambios) {
+        hubo_cambios = false;
+        recalcular();
+        for (size_t i = 0; i < total; ++i) {
+            SaltoRelajable& s = saltos_relajables[i];
+            if (s.largo || s.eliminado || s.alineacion) continue;
+
+            int fin = s.posicion + crecimiento_acumulado[i] + 2;
+            int destino = s.destino + crecimiento_antes(s.destino) + s.sumando;
+            int desplazamiento = destino - fin;
+            if (desplazamiento < -128 || desplazamiento > 127) {
+                s.largo = true;
+                hubo_cambios = true;
+            }
+        }
+    }
+
+    // Desplazar símbolos de .text y referencias ya registradas según el crecimiento
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        const int direccion = posicion_texto(id);
+        if (direccion != SIN_DEFINIR) tabla_simbolos[id] = direccion + crecimiento_antes(direccion);
+    }
+    for (auto& ref : referencias_pendientes) {
+        ref.posicion += crecimiento_antes(static_cast<int>(ref.posicion));
+    }
+
+    // Reconstruir el código con la forma definitiva de cada salto
+    vector<uint8_t>& nuevo_codigo = codigo_relajado;
+    nuevo_codigo.clear();
+    nuevo_codigo.reserve(codigo_hex.size() + crecimiento_acumulado[total]);
+    vector<ReferenciaPendiente>& refs_saltos = referencias_saltos;
+    refs_saltos.clear();
+
+    int anterior = 0;
+    uint64_t relleno_total = 0;
+    for (const auto& s : saltos_relajables) {
+        nuevo_codigo.insert(nuevo_codigo.end(), codigo_hex.begin() + anterior, codigo_hex.begin() + s.posicion);
+        if (s.alineacion) {
+            agregar_nops(nuevo_codigo, s.relleno);
+            relleno_total += s.relleno;
+            anterior = s.posicion;
+            continue;
+        }
+        anterior = s.posicion + 2;
+        if (s.eliminado) continue;
+
+        int tamano;
+        if (!s.largo) {
+            nuevo_codigo.push_back(s.condicional ? static_cast<uint8_t>(0x70 | s.condicion) : 0xEB);
+            tamano = 1;
+        } else if (s.condicional) {
+            nuevo_codigo.push_back(0x0F);
+            nuevo_codigo.push_back(static_cast<uint8_t>(0x80 | s.condicion));
+            tamano = 4;
+        } else {
+            nuevo_codigo.push_back(0xE9);
+            tamano = 4;
+        }
+
+        ReferenciaPendiente ref;
+        ref.posicion = static_cast<uint32_t>(nuevo_codigo.size());
+        ref.simbolo = s.simbolo;
+        ref.sumando = s.sumando;
+        ref.tamano_inmediato = static_cast<uint8_t>(tamano);
+        ref.tipo_salto = 1; // Relativo
+        refs_saltos.push_back(ref);
+
+        nuevo_codigo.insert(nuevo_codigo.end(), tamano, 0x00); // Se parcheará después
+    }
+    nuevo_codigo.insert(nuevo_codigo.end(), codigo_hex.begin() + anterior, codigo_hex.end());
+
+    codigo_hex.swap(nuevo_codigo);
+    contador_posicion += crecimiento_acumulado[total];
+    optimizaciones.saltos_al_siguiente += eliminados;
+    if (estadisticas.activas) {
+        estadisticas.saltos_relajables += saltos;
+        estadisticas.relleno_alineacion += relleno_total;
+        for (const auto& salto : saltos_relajables) estadisticas.saltos_largos += salto.largo;
+    }
+    saltos_relajables.clear();
+
+    // Intercalar las referencias de los saltos manteniendo el orden por posición
+    size_t previas = referencias_pendientes.size();
+    referencias_pendientes.insert(referencias_pendientes.end(), refs_saltos.begin(), refs_saltos.end());
+    inplace_merge(referencias_pendientes.begin(), referencias_pendientes.begin() + previas,
+                  referencias_pendientes.end(),
+                  [](const ReferenciaPendiente& x, const ReferenciaPendiente& y) { return x.posicion < y.posicion; });
+}
+
+// -----------------------------------------------------------------------------
+// 🕸️ Grafo de flujo (-O2)
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::optimizar_grafo_flujo() {
+    /*
+        Sobre el programa entero, antes de relajar (los saltos aún ocupan 2
+        bytes y el resto del código ya no se mueve):
+        1. Encadenamiento: un salto a un JMP pasa a saltar a su destino final.
+        2. Inversión: "Jcc A / JMP B / A:" queda en "J!cc B / A:" si nadie
+           más salta al JMP.
+        3. Bloques muertos: un bloque básico empieza en 0, en cada etiqueta,
+           tras cada salto y en cada destino ETIQUETA+N. Sus aristas son la
+           caída al siguiente (salvo tras un JMP), los saltos y cualquier
+           referencia a etiqueta (CALL, MOV r, etiqueta...). Desde el bloque
+           0, las etiquetas GLOBAL y _start (o _START), los que no se
+           alcanzan se quitan.
+        Sin saber dónde hay un RET se supone que todo bloque cae al siguiente:
+        se conservan bloques de más, nunca de menos.
+    */
+    vector<SaltoRelajable>& saltos = saltos_relajables;
+    const size_t total = saltos.size();
+    if (total == 0 || codigo_hex.empty()) return;
+    const int tamano = static_cast<int>(codigo_hex.size());
+    auto destino_de = [this](uint32_t simbolo, int32_t sumando) {
+        const int d = posicion_texto(simbolo);
+        return d == SIN_DEFINIR ? SIN_DEFINIR : d + sumando;
+    };
+
+    // JMP que empieza en 'posicion' (los ALIGN van delante en la misma posición)
+    auto jmp_en = [&](int posicion) -> int {
+        auto it = lower_bound(saltos.begin(), saltos.end(), posicion,
+                              [](const SaltoRelajable& x, int p) { return x.posicion < p; });
+        while (it != saltos.end() && it->posicion == posicion && it->alineacion) ++it;
+        if (it == saltos.end() || it->posicion != posicion || it->condicional) return -1;
+        return static_cast<int>(it - saltos.begin());
+    };
+
+    // 1. Encadenamiento (acotado: un ciclo de JMP se queda donde esté)
+    uint64_t encadenados = 0;
+    for (size_t i = 0; i < total; ++i) {
+        SaltoRelajable& s = saltos[i];
+        if (s.alineacion || s.sumando != 0) continue;
+        uint32_t simbolo = s.simbolo;
+        for (size_t pasos = 0; pasos < total; ++pasos) {
+            const int destino = posicion_texto(simbolo);
+            const int k = destino == SIN_DEFINIR ? -1 : jmp_en(destino);
+            if (k < 0 || static_cast<size_t>(k) == i || saltos[k].sumando != 0) break;
+            simbolo = saltos[k].simbolo;
+        }
+        if (simbolo != s.simbolo) {
+            s.simbolo = simbolo;
+            ++encadenados;
+        }
+    }
+
+    // Posiciones a las que se puede llegar por nombre: etiquetas de .text y
+    // ETIQUETA+N, también desde .data (DD etiqueta)
+    const vector<ReferenciaPendiente>& referencias_datos = secciones[static_cast<int>(SeccionELF::DATOS)].referencias;
+    vector<int> destinos;
+    destinos.reserve(tabla_simbolos.size());
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (posicion_texto(id) != SIN_DEFINIR) destinos.push_back(tabla_simbolos[id]);
+    }
+    auto con_sumando = [&](const vector<ReferenciaPendiente>& referencias) {
+        for (const ReferenciaPendiente& ref : referencias) {
+            if (ref.sumando != 0 && posicion_texto(ref.simbolo) != SIN_DEFINIR) {
+                destinos.push_back(destino_de(ref.simbolo, ref.sumando));
+            }
+        }
+    };
+    con_sumando(referencias_pendientes);
+    con_sumando(referencias_datos);
+    for (const SaltoRelajable& s : saltos) {
+        if (!s.alineacion && s.sumando != 0 && posicion_texto(s.simbolo) != SIN_DEFINIR) {
+            destinos.push_back(destino_de(s.simbolo, s.sumando));
+        }
+    }
+    sort(destinos.begin(), destinos.end());
+    destinos.erase(unique(destinos.begin(), destinos.end()), destinos.end());
+
+    // 2. Inversión de "Jcc A / JMP B / A:"
+    vector<bool> quitado(total, false);
+    vector<pair<int, int>> borrados; // Tramos [inicio, fin) a quitar
+    uint64_t invertidos = 0;
+    for (size_t i = 0; i + 1 < total; ++i) {
+        SaltoRelajable& s = saltos[i];
+        const SaltoRelajable& j = saltos[i + 1];
+        if (!s.condicional || s.alineacion || s.sumando != 0 || j.alineacion || j.condicional) continue;
+        if (j.posicion != s.posicion + 2 || posicion_texto(s.simbolo) != j.posicion + 2) continue;
+        if (binary_search(destinos.begin(), destinos.end(), j.posicion)) continue;
+        s.condicion ^= 1; // Los Jcc van por parejas: cc par / cc impar contrario
+        s.simbolo = j.simbolo;
+        s.sumando = j.sumando;
+        quitado[i + 1] = true;
+        borrados.push_back({j.posicion, j.posicion + 2});
+        ++invertidos;
+        ++i;
+    }
+
+    // 3. Bloques básicos y alcance
+    vector<int> lideres(destinos.begin(), destinos.end());
+    lideres.push_back(0);
+    for (size_t i = 0; i < total; ++i) {
+        if (!saltos[i].alineacion && !quitado[i]) lideres.push_back(saltos[i].posicion + 2);
+    }
+    sort(lideres.begin(), lideres.end());
+    lideres.erase(unique(lideres.begin(), lideres.end()), lideres.end());
+    while (!lideres.empty() && lideres.back() >= tamano) lideres.pop_back();
+    while (!lideres.empty() && lideres.front() < 0) lideres.erase(lideres.begin());
+    const size_t bloques = lideres.size();
+    auto bloque_de = [&](int posicion) -> int {
+        if (posicion < 0 || posicion >= tamano) return -1;
+        return static_cast<int>(upper_bound(lideres.begin(), lideres.end(), posicion) - lideres.begin()) - 1;
+    };
+
+    vector<bool> cae(bloques, true);
+    vector<pair<int, int>> aristas;
+    aristas.reserve(total + referencias_pendientes.size());
+    for (size_t i = 0; i < total; ++i) {
+        const SaltoRelajable& s = saltos[i];
+        if (s.alineacion || quitado[i]) continue;
+        const int origen = bloque_de(s.posicion);
+        if (!s.condicional) cae[origen] = false;
+        const int destino = bloque_de(destino_de(s.simbolo, s.sumando));
+        if (destino >= 0) aristas.push_back({origen, destino});
+    }
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        const int destino = bloque_de(destino_de(ref.simbolo, ref.sumando));
+        if (destino >= 0) aristas.push_back({bloque_de(static_cast<int>(ref.posicion)), destino});
+    }
+    sort(aristas.begin(), aristas.end());
+
+    vector<bool> vivo(bloques, false);
+    vector<int> pendientes;
+    auto alcanzar = [&](int b) {
+        if (b >= 0 && !vivo[b]) {
+            vivo[b] = true;
+            pendientes.push_back(b);
+        }
+    };
+    alcanzar(bloque_de(0));
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (posicion_texto(id) != SIN_DEFINIR && (simbolos_globales[id] || es_simbolo_entrada(simbolos.nombre(id)))) {
+            alcanzar(bloque_de(tabla_simbolos[id]));
+        }
+    }
+    for (const ReferenciaPendiente& ref : referencias_datos) alcanzar(bloque_de(destino_de(ref.simbolo, ref.sumando)));
+    while (!pendientes.empty()) {
+        const int b = pendientes.back();
+        pendientes.pop_back();
+        if (cae[b] && static_cast<size_t>(b) + 1 < bloques) alcanzar(b + 1);
+        auto it = lower_bound(aristas.begin(), aristas.end(), make_pair(b, -1));
+        for (; it != aristas.end() && it->first == b; ++it) alcanzar(it->second);
+    }
+
+    uint64_t muertos = 0, bytes_muertos = 0;
+    for (size_t b = 0; b < bloques; ++b) {
+        if (vivo[b]) continue;
+        const int fin = b + 1 < bloques ? lideres[b + 1] : tamano;
+        borrados.push_back({lideres[b], fin});
+        ++muertos;
+        bytes_muertos += static_cast<uint64_t>(fin - lideres[b]);
+    }
+
+    optimizaciones.saltos_encadenados += encadenados;
+    optimizaciones.saltos_invertidos += invertidos;
+    optimizaciones.bloques_muertos += muertos;
+    optimizaciones.bytes_muertos += bytes_muertos;
+    if (borrados.empty()) return;
+
+    // 4. Compactar: fundir los tramos y trasladar símbolos, referencias y saltos
+    sort(borrados.begin(), borrados.end());
+    vector<pair<int, int>> tramos;
+    for (const auto& t : borrados) {
+        if (!tramos.empty() && t.first <= tramos.back().second) {
+            tramos.back().second = max(tramos.back().second, t.second);
+        } else {
+            tramos.push_back(t);
+        }
+    }
+    vector<int> quitados_antes(tramos.size() + 1, 0); // Bytes quitados en los tramos [0, k)
+    for (size_t k = 0; k < tramos.size(); ++k) {
+        quitados_antes[k + 1] = quitados_antes[k] + tramos[k].second - tramos[k].first;
+    }
+    // Tramo que contiene 'posicion' (o -1) y posición tras compactar; lo que
+    // estaba dentro de un tramo quitado pasa a su inicio
+    auto trasladar = [&](int posicion, bool& dentro) {
+        auto it = upper_bound(tramos.begin(), tramos.end(), make_pair(posicion, INT_MAX));
+        const size_t k = static_cast<size_t>(it - tramos.begin());
+        dentro = k > 0 && posicion < tramos[k - 1].second;
+        if (dentro) return tramos[k - 1].first - quitados_antes[k - 1];
+        return posicion - quitados_antes[k];
+    };
+
+    if (analizar) quitar_de_analisis(tramos, true); // Antes de mover los símbolos
+    bool dentro;
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (posicion_texto(id) != SIN_DEFINIR) tabla_simbolos[id] = trasladar(tabla_simbolos[id], dentro);
+    }
+    size_t n = 0;
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        const int posicion = trasladar(static_cast<int>(ref.posicion), dentro);
+        if (dentro) continue;
+        referencias_pendientes[n] = ref;
+        referencias_pendientes[n++].posicion = static_cast<uint32_t>(posicion);
+    }
+    referencias_pendientes.resize(n);
+    n = 0;
+    for (size_t i = 0; i < total; ++i) {
+        const int posicion = trasladar(saltos[i].posicion, dentro);
+        if (dentro || quitado[i]) continue;
+        saltos[n] = saltos[i];
+        saltos[n++].posicion = posicion;
+    }
+    saltos.resize(n);
+
+    size_t destino = 0, anterior = 0;
+    for (const auto& t : tramos) {
+        const size_t inicio = static_cast<size_t>(t.first);
+        copy(codigo_hex.begin() + anterior, codigo_hex.begin() + inicio, codigo_hex.begin() + destino);
+        destino += inicio - anterior;
+        anterior = static_cast<size_t>(t.second);
+    }
+    copy(codigo_hex.begin() + anterior, codigo_hex.end(), codigo_hex.begin() + destino);
+    destino += codigo_hex.size() - anterior;
+    codigo_hex.resize(destino);
+    contador_posicion -= quitados_antes.back();
+}
+
+// -----------------------------------------------------------------------------
+// 🧩 Resolución de referencias pendientes
+// -----------------------------------------------------------------------------
+
+namespace {
+    // Valor del campo de una referencia cuyo destino ya se conoce
+    uint32_t valor_referencia(const ReferenciaPendiente& ref, int destino) {
+        if (ref.tipo_salto == 0) return static_cast<uint32_t>(destino + ref.sumando);   // Absoluto
+        const int siguiente = static_cast<int>(ref.posicion) + ref.tamano_inmediato;    // Relativo
+        return static_cast<uint32_t>(destino + ref.sumando - siguiente);
+    }
+
+    void poner_dword(uint8_t* p, uint32_t valor) {
+        p[0] = static_cast<uint8_t>(valor);
+        p[1] = static_cast<uint8_t>(valor >> 8);
+        p[2] = static_cast<uint8_t>(valor >> 16);
+        p[3] = static_cast<uint8_t>(valor >> 24);
+    }
+}
+
+void EnsambladorIA32::avisar_no_definida(uint32_t id) {
+    if (avisados[id]) return;
+    *diagnosticos << "Advertencia: Etiqueta no definida '" << simbolos.nombre(id) << "'. Referencia no resuelta." << endl;
+    avisados[id] = true;
+    if (estadisticas.activas) ++estadisticas.simbolos_sin_resolver;
+}
+
+void EnsambladorIA32::resolver_referencias_datos() {
+    // En .data sólo hay direcciones absolutas (DD etiqueta)
+    ContenidoSeccion& datos = secciones[static_cast<int>(SeccionELF::DATOS)];
+    for (const ReferenciaPendiente& ref : datos.referencias) {
+        if (tabla_simbolos[ref.simbolo] == SIN_DEFINIR) {
+            avisar_no_definida(ref.simbolo);
+            continue;
+        }
+        poner_dword(&datos.codigo[ref.posicion], valor_referencia(ref, static_cast<int>(direccion_simbolo(ref.simbolo))));
+    }
+}
+
+void EnsambladorIA32::resolver_referencias_pendientes() {
+    // Todo se resuelve con .text activa. Fijar primero el tamaño de los
+    // saltos (mueve símbolos y referencias) y después el relleno de los ALIGN
+    // de .data y .bss, que van detrás
+    seleccionar_seccion(SeccionELF::TEXTO);
+    uint64_t t0 = estadisticas.activas ? reloj_ns() : 0;
+    if (optimizar_flujo) optimizar_grafo_flujo();
+    relajar_saltos();
+    alinear_seccion(SeccionELF::DATOS);
+    alinear_seccion(SeccionELF::BSS);
+    if (estadisticas.activas) {
+        estadisticas.ns_relajacion += reloj_ns() - t0;
+        estadisticas.referencias_pendientes += referencias_pendientes.size();
+        t0 = reloj_ns();
+    }
+
+    // Un único barrido lineal: las referencias están ordenadas por posición,
+    // así que los parches recorren codigo_hex de principio a fin
+    avisados.assign(tabla_simbolos.size(), false);
+    for (const auto& ref : referencias_pendientes) {
+        if (tabla_simbolos[ref.simbolo] == SIN_DEFINIR) {
+            avisar_no_definida(ref.simbolo);
+            continue;
+        }
+        const int destino = static_cast<int>(direccion_simbolo(ref.simbolo));
+
+        int pos = static_cast<int>(ref.posicion);
+        uint32_t valor_a_parchear = valor_referencia(ref, destino);
+
+        // Escribir el valor en codigo_hex (little-endian)
+        if (ref.tamano_inmediato == 1) {
+            int offset = static_cast<int32_t>(valor_a_parchear);
+            if (offset < -128 || offset > 127) {
+                *diagnosticos << "Error: Salto corto fuera de rango hacia '" << simbolos.nombre(ref.simbolo) << "'." << endl;
+            }
+            codigo_hex[pos] = static_cast<uint8_t>(valor_a_parchear & 0xFF);
+        } else if (pos + 3 < static_cast<int>(codigo_hex.size())) {
+            codigo_hex[pos]     = static_cast<uint8_t>(valor_a_parchear & 0xFF);
+            codigo_hex[pos + 1] = static_cast<uint8_t>((valor_a_parchear >> 8) & 0xFF);
+            codigo_hex[pos + 2] = static_cast<uint8_t>((valor_a_parchear >> 16) & 0xFF);
+            codigo_hex[pos + 3] = static_cast<uint8_t>((valor_a_parchear >> 24) & 0xFF);
+        } else {
+            *diagnosticos << "Error: Referencia fuera de rango al parchear." << endl;
+        }
+    }
+    resolver_referencias_datos();
+
+    // Imagen plana (bin, hex y uso embebido): .data tras .text, alineada;
+    // .bss no ocupa nada
+    imagen_plana.clear();
+    const vector<uint8_t>& datos = secciones[static_cast<int>(SeccionELF::DATOS)].codigo;
+    if (!datos.empty()) {
+        const uint32_t base_datos = base_seccion(SeccionELF::DATOS);
+        imagen_plana.reserve(base_datos + datos.size());
+        imagen_plana.assign(codigo_hex.begin(), codigo_hex.end());
+        imagen_plana.resize(base_datos, 0);
+        imagen_plana.insert(imagen_plana.end(), datos.begin(), datos.end());
+    }
+
+    if (estadisticas.activas) estadisticas.ns_resolucion += reloj_ns() - t0;
+}
+
+// -----------------------------------------------------------------------------
+// 🏗️ Proceso de ensamblado principal
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::ensamblar(const string& archivo_entrada) {
+    // El archivo se proyecta en memoria y cada línea es una vista sobre el
+    // mapeo: no hay copias ni reservas de memoria por línea
+    const uint64_t t0 = estadisticas.activas ? reloj_ns() : 0;
+    LectorFuente lector;
+    if (!lector.abrir(archivo_entrada)) {
+        *diagnosticos << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+        return;
+    }
+    if (estadisticas.activas) estadisticas.ns_lectura += reloj_ns() - t0;
+    fijar_origen(archivo_entrada);
+
+    // Reservar de antemano: ~1 byte de código por cada 4 de fuente
+    codigo_hex.reserve(codigo_hex.size() + lector.contenido().size() / 4);
+
+    ensamblar_texto(lector.contenido());
+}
+
+void EnsambladorIA32::ensamblar_texto_fuente(string_view fuente) {
+    codigo_hex.reserve(codigo_hex.size() + fuente.size() / 4);
+    ensamblar_texto(fuente);
+}
+
+void EnsambladorIA32::ensamblar_texto(string_view texto) {
+    if (estadisticas.activas) {
+        ensamblar_texto_medido(texto);
+        return;
+    }
+
+    EscanerLineas escaner(texto);
+    LineaEscaneada linea;
+    while (escaner.siguiente(linea)) {
+        procesar_linea(linea);
+        if (salida_continua && seccion_actual == SeccionELF::TEXTO && codigo_hex.size() >= SalidaContinua::TAMANO_BLOQUE) {
+            volcar_ventana_continua();
+        }
+    }
+    vaciar_ventana(); // Los operandos de la ventana apuntan a 'texto'
+}
+
+void EnsambladorIA32::ensamblar_texto_medido(string_view texto) {
+    // El tiempo léxico es el total del bucle menos lo que se midió como
+    // codificación dentro de procesar_instruccion
+    auto total_codificacion = [this]() {
+        uint64_t suma = 0;
+        for (uint64_t ns : estadisticas.ns_codificacion) suma += ns;
+        return suma;
+    };
+    const uint64_t codificacion_antes = total_codificacion();
+    const uint64_t t0 = reloj_ns();
+
+    EscanerLineas escaner(texto);
+    LineaEscaneada linea;
+    while (escaner.siguiente(linea)) {
+        ++estadisticas.lineas;
+        procesar_linea(linea);
+        if (salida_continua && seccion_actual == SeccionELF::TEXTO && codigo_hex.size() >= SalidaContinua::TAMANO_BLOQUE) {
+            volcar_ventana_continua();
+        }
+    }
+    vaciar_ventana();
+
+    estadisticas.ns_lexico += (reloj_ns() - t0) - (total_codificacion() - codificacion_antes);
+}
+
+// -----------------------------------------------------------------------------
+// 🌊 Salida continua (--stream)
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::emitir_salto_continuo(bool condicional, uint8_t condicion, string_view etiqueta,
+                                            int32_t sumando) {
+    // Sin relajación: hacia atrás el destino ya se conoce y se elige la forma
+    // buena; hacia delante va siempre la larga, con el rel32 por parchear
+    const uint32_t id = id_simbolo(etiqueta);
+    const int destino = posicion_texto(id);
+    if (destino != SIN_DEFINIR) {
+        const int corto = destino + sumando - (contador_posicion + 2);
+        if (corto >= -128 && corto <= 127) {
+            agregar_byte(condicional ? static_cast<uint8_t>(0x70 | condicion) : 0xEB);
+            agregar_byte(static_cast<uint8_t>(corto));
+            return;
+        }
+    }
+
+    if (condicional) {
+        agregar_byte(0x0F);
+        agregar_byte(static_cast<uint8_t>(0x80 | condicion));
+    } else {
+        agregar_byte(0xE9);
+    }
+    if (destino != SIN_DEFINIR) {
+        agregar_dword(static_cast<uint32_t>(destino + sumando - (contador_posicion + 4)));
+    } else {
+        registrar_referencia(etiqueta, 4, 1, sumando);
+        agregar_dword(0);
+    }
+}
+
+void EnsambladorIA32::alinear_continuo(uint16_t alineacion, uint16_t relleno_maximo) {
+    // Las posiciones ya son definitivas: el relleno se emite en el momento
+    const size_t relleno = static_cast<size_t>(-contador_posicion) & (alineacion - 1u);
+    if (relleno == 0 || relleno > relleno_maximo) return;
+    agregar_nops(codigo_hex, relleno);
+    contador_posicion += static_cast<int>(relleno);
+    if (estadisticas.activas) estadisticas.relleno_alineacion += relleno;
+}
+
+void EnsambladorIA32::volcar_ventana_continua() {
+    // Las referencias de la ventana con etiqueta de .text ya definida se
+    // parchean aquí; las demás (también las que van a .data o .bss, cuya
+    // dirección depende del tamaño final de .text) pasan a la lista de su
+    // símbolo y el bloque queda retenido
+    uint32_t pendientes = 0;
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        const int destino = posicion_texto(ref.simbolo);
+        if (destino != SIN_DEFINIR) {
+            poner_dword(&codigo_hex[ref.posicion - base_continua], valor_referencia(ref, destino));
+            continue;
+        }
+
+        uint32_t nodo = parche_libre;
+        if (nodo == SIN_PARCHE) {
+            nodo = static_cast<uint32_t>(parches_continuos.size());
+            parches_continuos.push_back({});
+        } else {
+            parche_libre = parches_continuos[nodo].siguiente;
+        }
+        if (ref.simbolo >= primer_parche.size()) primer_parche.resize(tabla_simbolos.size(), SIN_PARCHE);
+        parches_continuos[nodo] = {ref, primer_parche[ref.simbolo]};
+        primer_parche[ref.simbolo] = nodo;
+        ++pendientes;
+    }
+    referencias_pendientes.clear();
+
+    if (!codigo_hex.empty()) salida_continua->entregar(static_cast<uint64_t>(base_continua), codigo_hex, pendientes);
+    base_continua = contador_posicion;
+}
+
+void EnsambladorIA32::resolver_parches_continuos(uint32_t simbolo) {
+    if (simbolo >= primer_parche.size()) return;
+    const int destino = static_cast<int>(direccion_simbolo(simbolo));
+    uint32_t nodo = primer_parche[simbolo];
+    while (nodo != SIN_PARCHE) {
+        ParcheContinuo& parche = parches_continuos[nodo];
+        uint8_t valor[4];
+        poner_dword(valor, valor_referencia(parche.ref, destino));
+        salida_continua->parchear(parche.ref.posicion, valor, 4);
+
+        const uint32_t siguiente = parche.siguiente;
+        parche.siguiente = parche_libre;
+        parche_libre = nodo;
+        nodo = siguiente;
+    }
+    primer_parche[simbolo] = SIN_PARCHE;
+}
+
+bool EnsambladorIA32::ensamblar_continuo(const string& archivo_entrada, const string& archivo_salida,
+                                         const string& formato, ResumenSalidaContinua* resumen) {
+    LectorFuente lector;
+    if (!lector.abrir(archivo_entrada)) {
+        *diagnosticos << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+        return false;
+    }
+    SalidaContinua salida;
+    if (!salida.abrir(archivo_salida, formato == "hex")) {
+        *diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return false;
+    }
+    fijar_origen(archivo_entrada);
+
+    salida_continua = &salida;
+    base_continua = contador_posicion - static_cast<int>(codigo_hex.size());
+    codigo_hex.reserve(SalidaContinua::TAMANO_BLOQUE);
+    ensamblar_texto(lector.contenido());
+    seleccionar_seccion(SeccionELF::TEXTO);
+    volcar_ventana_continua();
+
+    // .data y .bss van detrás de .text, cuyo tamaño ya se conoce: se
+    // resuelven las listas de sus etiquetas y .data sale al final
+    alinear_seccion(SeccionELF::DATOS);
+    alinear_seccion(SeccionELF::BSS);
+    for (uint32_t id = 0; id < primer_parche.size(); ++id) {
+        if (tabla_simbolos[id] != SIN_DEFINIR) resolver_parches_continuos(id);
+    }
+    salida_continua = nullptr;
+
+    // Lo que queda en las listas no encontró su etiqueta: se avisa como en
+    // resolver_referencias_pendientes (una vez por etiqueta, en orden de
+    // posición) y queda en referencias_pendientes para el reporte
+    for (uint32_t id = 0; id < primer_parche.size(); ++id) {
+        for (uint32_t nodo = primer_parche[id]; nodo != SIN_PARCHE; nodo = parches_continuos[nodo].siguiente) {
+            referencias_pendientes.push_back(parches_continuos[nodo].ref);
+        }
+    }
+    sort(referencias_pendientes.begin(), referencias_pendientes.end(),
+         [](const ReferenciaPendiente& a, const ReferenciaPendiente& b) { return a.posicion < b.posicion; });
+    avisados.assign(tabla_simbolos.size(), false);
+    for (const ReferenciaPendiente& ref : referencias_pendientes) avisar_no_definida(ref.simbolo);
+    parches_continuos.clear();
+    primer_parche.clear();
+    parche_libre = SIN_PARCHE;
+
+    resolver_referencias_datos();
+    const vector<uint8_t>& datos = secciones[static_cast<int>(SeccionELF::DATOS)].codigo;
+    if (!datos.empty()) {
+        vector<uint8_t> bloque(base_seccion(SeccionELF::DATOS) - static_cast<uint32_t>(contador_posicion), 0);
+        bloque.insert(bloque.end(), datos.begin(), datos.end());
+        salida.entregar(static_cast<uint64_t>(contador_posicion), bloque, 0);
+    }
+
+    const bool correcto = salida.cerrar();
+    if (!correcto) *diagnosticos << "Error: No se pudo escribir la salida: " << archivo_salida << endl;
+    if (resumen) *resumen = salida.resumen();
+    return correcto;
+}
+
+// -----------------------------------------------------------------------------
+// 🧵 Ensamblado paralelo
+// -----------------------------------------------------------------------------
+
+bool EnsambladorIA32::es_frontera_segura(const LineaEscaneada& linea) {
+    // Se puede cortar antes de una definición de etiqueta o de un SECTION
+    string_view token = linea.texto.substr(0, linea.fin_token);
+    if (token.size() > 1 && token.back() == ':') return true;
+
+    Mnemonico id = buscar_mnemonico(token.data(), token.size());
+    return id == Mnemonico::SECTION;
+}
+
+namespace {
+    // Añade al final de 'destino' la sección de un fragmento ensamblado desde 0
+    void anexar_seccion(ContenidoSeccion& destino, const ContenidoSeccion& parte, const uint32_t* ids) {
+        const int base = destino.posicion;
+        destino.codigo.insert(destino.codigo.end(), parte.codigo.begin(), parte.codigo.end());
+        destino.posicion += parte.posicion;
+        for (ReferenciaPendiente ref : parte.referencias) {
+            ref.posicion += static_cast<uint32_t>(base);
+            ref.simbolo = ids[ref.simbolo];
+            destino.referencias.push_back(ref);
+        }
+        for (SaltoRelajable punto : parte.saltos) { // Sólo ALIGN
+            punto.posicion += base;
+            destino.saltos.push_back(punto);
+        }
+    }
+}
+
+void EnsambladorIA32::enlazar_fragmento(const EnsambladorIA32& fragmento, SeccionELF seccion_final) {
+    // El fragmento se ensambló desde la posición 0 de cada sección con su
+    // propio internador (y acabó con .text activa): se desplaza a la posición
+    // actual de cada sección y se traducen sus IDs de símbolo
+    seleccionar_seccion(SeccionELF::TEXTO);
+    const int base = contador_posicion;
+    const int bases[] = {0, base, secciones[static_cast<int>(SeccionELF::DATOS)].posicion,
+                         secciones[static_cast<int>(SeccionELF::BSS)].posicion};
+
+    vector<uint32_t> ids(fragmento.simbolos.total());
+    for (uint32_t id = 0; id < ids.size(); ++id) {
+        ids[id] = id_simbolo(fragmento.simbolos.nombre(id));
+        if (fragmento.simbolos_globales[id]) simbolos_globales[ids[id]] = true;
+        if (fragmento.tabla_simbolos[id] != SIN_DEFINIR) {
+            const SeccionELF seccion = fragmento.secciones_simbolos[id];
+            tabla_simbolos[ids[id]] = fragmento.tabla_simbolos[id] + bases[static_cast<int>(seccion)];
+            secciones_simbolos[ids[id]] = seccion;
+        }
+    }
+
+    codigo_hex.insert(codigo_hex.end(), fragmento.codigo_hex.begin(), fragmento.codigo_hex.end());
+    contador_posicion += fragmento.contador_posicion;
+
+    for (ReferenciaPendiente ref : fragmento.referencias_pendientes) {
+        ref.posicion += static_cast<uint32_t>(base);
+        ref.simbolo = ids[ref.simbolo];
+        referencias_pendientes.push_back(ref);
+    }
+    for (SaltoRelajable salto : fragmento.saltos_relajables) {
+        salto.posicion += base;
+        if (!salto.alineacion) salto.simbolo = ids[salto.simbolo];
+        saltos_relajables.push_back(salto);
+    }
+    anexar_seccion(secciones[static_cast<int>(SeccionELF::DATOS)], fragmento.secciones[static_cast<int>(SeccionELF::DATOS)], ids.data());
+    anexar_seccion(secciones[static_cast<int>(SeccionELF::BSS)], fragmento.secciones[static_cast<int>(SeccionELF::BSS)], ids.data());
+    optimizaciones.acumular(fragmento.optimizaciones);
+
+    const uint32_t base_instrucciones = static_cast<uint32_t>(instrucciones_analisis.size());
+    for (InstruccionAnalizada ins : fragmento.instrucciones_analisis) {
+        if (ins.destino != InternadorSimbolos::NINGUNO) ins.destino = ids[ins.destino];
+        ins.posicion += base;
+        instrucciones_analisis.push_back(ins);
+    }
+    for (EtiquetaAnalizada etiqueta : fragmento.etiquetas_analisis) {
+        etiqueta.instruccion += base_instrucciones;
+        etiqueta.simbolo = ids[etiqueta.simbolo];
+        etiquetas_analisis.push_back(etiqueta);
+    }
+    dependencias.insert(dependencias.end(), fragmento.dependencias.begin(), fragmento.dependencias.end());
+    seleccionar_seccion(seccion_final);
+}
+
+void EnsambladorIA32::extraer_fragmento(FragmentoCodificado& fragmento) {
+    // Se guarda con .text activa, anotando en qué sección terminó
+    fragmento.seccion_final = seccion_actual;
+    seleccionar_seccion(SeccionELF::TEXTO);
+    fragmento.codigo = codigo_hex;
+    fragmento.nombres.clear();
+    fragmento.fin_nombres.clear();
+    for (uint32_t id = 0; id < simbolos.total(); ++id) {
+        fragmento.nombres.append(simbolos.nombre(id));
+        fragmento.fin_nombres.push_back(static_cast<uint32_t>(fragmento.nombres.size()));
+    }
+    fragmento.posiciones = tabla_simbolos;
+    fragmento.globales = simbolos_globales;
+    fragmento.secciones_simbolos = secciones_simbolos;
+    fragmento.referencias = referencias_pendientes;
+    fragmento.saltos = saltos_relajables;
+    fragmento.datos = secciones[static_cast<int>(SeccionELF::DATOS)];
+    fragmento.bss = secciones[static_cast<int>(SeccionELF::BSS)];
+    fragmento.optimizaciones = optimizaciones;
+}
+
+void EnsambladorIA32::enlazar_codificado(const FragmentoCodificado& fragmento) {
+    // Igual que enlazar_fragmento, pero desde un fragmento guardado en caché
+    seleccionar_seccion(SeccionELF::TEXTO);
+    const int base = contador_posicion;
+    const int bases[] = {0, base, secciones[static_cast<int>(SeccionELF::DATOS)].posicion,
+                         secciones[static_cast<int>(SeccionELF::BSS)].posicion};
+    *diagnosticos << fragmento.diagnosticos;
+
+    uint32_t ids_locales[16];
+    vector<uint32_t> ids_grandes;
+    uint32_t* ids = ids_locales;
+    if (fragmento.fin_nombres.size() > 16) {
+        ids_grandes.resize(fragmento.fin_nombres.size());
+        ids = ids_grandes.data();
+    }
+
+    for (uint32_t id = 0; id < fragmento.fin_nombres.size(); ++id) {
+        ids[id] = id_simbolo(fragmento.nombre(id));
+        if (fragmento.globales[id]) simbolos_globales[ids[id]] = true;
+        if (fragmento.posiciones[id] != SIN_DEFINIR) {
+            const SeccionELF seccion = fragmento.secciones_simbolos[id];
+            tabla_simbolos[ids[id]] = fragmento.posiciones[id] + bases[static_cast<int>(seccion)];
+            secciones_simbolos[ids[id]] = seccion;
+        }
+    }
+
+    codigo_hex.insert(codigo_hex.end(), fragmento.codigo.begin(), fragmento.codigo.end());
+    contador_posicion += static_cast<int>(fragmento.codigo.size());
+
+    for (ReferenciaPendiente ref : fragmento.referencias) {
+        ref.posicion += static_cast<uint32_t>(base);
+        ref.simbolo = ids[ref.simbolo];
+        referencias_pendientes.push_back(ref);
+    }
+    for (SaltoRelajable salto : fragmento.saltos) {
+        salto.posicion += base;
+        if (!salto.alineacion) salto.simbolo = ids[salto.simbolo];
+        saltos_relajables.push_back(salto);
+    }
+    anexar_seccion(secciones[static_cast<int>(SeccionELF::DATOS)], fragmento.datos, ids);
+    anexar_seccion(secciones[static_cast<int>(SeccionELF::BSS)], fragmento.bss, ids);
+    optimizaciones.acumular(fragmento.optimizaciones);
+    seleccionar_seccion(fragmento.seccion_final);
+}
+
+void EnsambladorIA32::ensamblar_paralelo(const string& archivo_entrada, unsigned hilos) {
+    uint64_t t0 = estadisticas.activas ? reloj_ns() : 0;
+    LectorFuente lector;
+    if (!lector.abrir(archivo_entrada)) {
+        *diagnosticos << "No se pudo abrir el archivo: " << archivo_entrada << endl;
+        return;
+    }
+    if (estadisticas.activas) estadisticas.ns_lectura += reloj_ns() - t0;
+    fijar_origen(archivo_entrada);
+    if (!modulos) modulos = make_shared<CacheModulos>(); // Una sola caché para todos los fragmentos
+
+    PoolHilos pool(hilos);
+    const string_view texto = lector.contenido();
+
+    // 1. Dividir en fragmentos de ~1/4 del reparto por hilo (para que el robo de
+    //    tareas equilibre la carga), cortando sólo en fronteras seguras
+    const size_t tamano_minimo = 64 * 1024;
+    const size_t objetivo = max(tamano_minimo, texto.size() / (pool.total_hilos() * 4));
+
+    vector<string_view> fragmentos;
+    size_t inicio = 0;
+    while (inicio < texto.size()) {
+        size_t corte = texto.size();
+        if (texto.size() - inicio > objetivo) {
+            size_t cursor = texto.find('\n', inicio + objetivo);
+            cursor = cursor == string_view::npos ? texto.size() : cursor + 1;
+
+            EscanerLineas escaner(texto.substr(cursor));
+            LineaEscaneada linea;
+            corte = texto.size();
+            while (escaner.siguiente(linea)) {
+                if (es_frontera_segura(linea)) {
+                    corte = cursor + linea.comienzo;
+                    break;
+                }
+            }
+        }
+        fragmentos.push_back(texto.substr(inicio, corte - inicio));
+        inicio = corte;
+    }
+
+    // 2. Sección en la que empieza cada fragmento: la del último SECTION de
+    //    los anteriores (se busca en paralelo)
+    const size_t total = fragmentos.size();
+    vector<int> ultima_seccion(total, -1);
+    for (size_t i = 0; i + 1 < total; ++i) {
+        pool.enviar([&, i]() {
+            EscanerLineas escaner(fragmentos[i]);
+            LineaEscaneada linea;
+            SeccionELF seccion;
+            while (escaner.siguiente(linea)) {
+                if (seccion_de_linea(linea, seccion)) ultima_seccion[i] = static_cast<int>(seccion);
+            }
+        });
+    }
+    pool.esperar();
+    vector<SeccionELF> iniciales(total, seccion_actual), finales(total);
+    for (size_t i = 1; i < total; ++i) {
+        iniciales[i] = ultima_seccion[i - 1] >= 0 ? static_cast<SeccionELF>(ultima_seccion[i - 1]) : iniciales[i - 1];
+    }
+
+    // 3. Codificar cada fragmento con su propio estado y búfer de código
+    vector<unique_ptr<EnsambladorIA32>> partes(total);
+    vector<ostringstream> mensajes(total);
+    auto codificar_parte = [&](size_t i) {
+        partes[i].reset(new EnsambladorIA32());
+        partes[i]->diagnosticos = &mensajes[i];
+        partes[i]->estadisticas.activas = estadisticas.activas;
+        partes[i]->optimizar = optimizar;
+        partes[i]->analizar = analizar;
+        partes[i]->modulos = modulos;
+        partes[i]->directorio_fuente = directorio_fuente;
+        partes[i]->pila_inclusion = pila_inclusion;
+        partes[i]->seleccionar_seccion(iniciales[i]);
+        partes[i]->codigo_hex.reserve(fragmentos[i].size() / 4);
+        partes[i]->ensamblar_texto(fragmentos[i]);
+        finales[i] = partes[i]->seccion_actual;
+        partes[i]->seleccionar_seccion(SeccionELF::TEXTO);
+    };
+    for (size_t i = 0; i < total; ++i) pool.enviar([&, i]() { codificar_parte(i); });
+    pool.esperar();
+
+    // 4. Enlace secuencial: bases de cada fragmento y traducción de símbolos.
+    //    La relajación y los parches se hacen después sobre el programa entero.
+    //    Si un %include cambió de sección, el fragmento siguiente empezó en
+    //    otra: se vuelve a codificar aquí con la buena
+    if (estadisticas.activas) t0 = reloj_ns();
+    size_t total_codigo = codigo_hex.size();
+    for (const auto& parte : partes) total_codigo += parte->codigo_hex.size();
+    codigo_hex.reserve(total_codigo);
+
+    for (size_t i = 0; i < total; ++i) {
+        if (iniciales[i] != seccion_actual) {
+            iniciales[i] = seccion_actual;
+            mensajes[i].str("");
+            codificar_parte(i);
+        }
+        *diagnosticos << mensajes[i].str();
+        enlazar_fragmento(*partes[i], finales[i]);
+        if (estadisticas.activas) estadisticas.acumular(partes[i]->estadisticas);
+        partes[i].reset();
+    }
+    if (estadisticas.activas) estadisticas.ns_enlace += reloj_ns() - t0;
+}
+
+void EnsambladorIA32::generar_hex(const string& archivo_salida) {
+    CronometroEtapa cronometro(estadisticas.activas ? &estadisticas.ns_salida : nullptr);
+    // Todo el texto se formatea en un búfer con una tabla de búsqueda y se
+    // escribe de una vez
+    string texto;
+    formatear_hex(salida_plana(), texto);
+    if (!volcar_archivo(archivo_salida, texto.data(), texto.size())) {
+        *diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+    }
+}
+
+void EnsambladorIA32::generar_binario(const string& archivo_salida) {
+    CronometroEtapa cronometro(estadisticas.activas ? &estadisticas.ns_salida : nullptr);
+    // Imagen plana: el código tal cual, con origen en 0
+    const vector<uint8_t>& plana = salida_plana();
+    if (!volcar_archivo(archivo_salida, plana.data(), plana.size())) {
+        *diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+    }
+}
+
+bool EnsambladorIA32::construir_elf(bool ejecutable, vector<uint8_t>& salida) {
+    /*
+        Las referencias ya resueltas (de .text y de .data) se traducen a
+        reubicaciones ELF:
+        - Absoluta a etiqueta definida: R_386_32 contra la sección de la
+          etiqueta; el campo pasa a llevar su desplazamiento en ella + sumando
+        - Relativa a etiqueta definida: nada si está en la misma sección; si
+          no, R_386_PC32 contra la suya
+        - A etiqueta indefinida (EXTERN): R_386_32 / R_386_PC32 contra el
+          símbolo, con el sumando implícito escrito en el campo
+    */
+    const ContenidoSeccion& datos = secciones[static_cast<int>(SeccionELF::DATOS)];
+    ImagenELF imagen;
+    imagen.texto = codigo_hex;
+    imagen.datos = datos.codigo;
+    imagen.tamano_bss = static_cast<uint32_t>(secciones[static_cast<int>(SeccionELF::BSS)].posicion);
+    imagen.alineacion_texto = alineacion_maxima; // Los ALIGN sólo valen si .text está igual de alineado
+    imagen.alineacion_datos = alineacion_datos;
+
+    vector<uint32_t> indice_elf(tabla_simbolos.size(), ReubicacionELF::SIN_SIMBOLO);
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] == SIN_DEFINIR) continue;
+        indice_elf[id] = static_cast<uint32_t>(imagen.simbolos.size());
+        imagen.simbolos.push_back({simbolos.nombre(id), static_cast<uint32_t>(tabla_simbolos[id]), 0,
+                                   secciones_simbolos[id], static_cast<bool>(simbolos_globales[id])});
+    }
+
+    auto traducir = [&](SeccionELF seccion, vector<uint8_t>& contenido, const vector<ReferenciaPendiente>& referencias) {
+        for (const auto& ref : referencias) {
+            ReubicacionELF r;
+            r.seccion = seccion;
+            r.posicion = ref.posicion;
+            r.destino = SeccionELF::TEXTO;
+            r.simbolo = ReubicacionELF::SIN_SIMBOLO;
+            r.tipo = ref.tipo_salto == 0 ? R_386_32 : R_386_PC32;
+
+            uint32_t sumando;
+            if (tabla_simbolos[ref.simbolo] != SIN_DEFINIR) {
+                r.destino = secciones_simbolos[ref.simbolo];
+                if (ref.tipo_salto == 1 && r.destino == seccion) continue;
+                // Sumando implícito contra el inicio de la sección de la etiqueta
+                sumando = static_cast<uint32_t>(tabla_simbolos[ref.simbolo] + ref.sumando - (ref.tipo_salto == 0 ? 0 : 4));
+            } else {
+                if (ref.tamano_inmediato != 4) {
+                    *diagnosticos << "Error: Referencia de 8 bits a la etiqueta externa '"
+                                  << simbolos.nombre(ref.simbolo) << "'." << endl;
+                    continue;
+                }
+                if (indice_elf[ref.simbolo] == ReubicacionELF::SIN_SIMBOLO) {
+                    indice_elf[ref.simbolo] = static_cast<uint32_t>(imagen.simbolos.size());
+                    imagen.simbolos.push_back({simbolos.nombre(ref.simbolo), 0, 0, SeccionELF::NINGUNA, true});
+                }
+                // Sumando implícito (REL): S + A, o S + A - P con A = sumando - 4
+                sumando = static_cast<uint32_t>(ref.tipo_salto == 0 ? ref.sumando : ref.sumando - 4);
+                r.simbolo = indice_elf[ref.simbolo];
+            }
+            for (int k = 0; k < 4; ++k) contenido[ref.posicion + k] = static_cast<uint8_t>(sumando >> (8 * k));
+            imagen.reubicaciones.push_back(r);
+        }
+    };
+    traducir(SeccionELF::TEXTO, imagen.texto, referencias_pendientes);
+    traducir(SeccionELF::DATOS, imagen.datos, datos.referencias);
+
+    string error;
+    if (!construir_elf32(imagen, ejecutable, salida, error)) {
+        *diagnosticos << "Error al generar ELF: " << error << endl;
+        return false;
+    }
+    return true;
+}
+
+void EnsambladorIA32::generar_elf(const string& archivo_salida, bool ejecutable) {
+    CronometroEtapa cronometro(estadisticas.activas ? &estadisticas.ns_salida : nullptr);
+    vector<uint8_t> salida;
+    if (!construir_elf(ejecutable, salida)) return;
+    if (!volcar_archivo(archivo_salida, salida.data(), salida.size(), ejecutable)) {
+        *diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+    }
+}
+
+void EnsambladorIA32::generar_reportes(const string& archivo_simbolos, const string& archivo_referencias) {
+    CronometroEtapa cronometro(estadisticas.activas ? &estadisticas.ns_salida : nullptr);
+    string texto_simbolos, texto_referencias;
+    construir_reportes(texto_simbolos, texto_referencias);
+    volcar_archivo(archivo_simbolos, texto_simbolos.data(), texto_simbolos.size());
+    volcar_archivo(archivo_referencias, texto_referencias.data(), texto_referencias.size());
+}
+
+void EnsambladorIA32::construir_reportes(string& texto_simbolos, string& texto_referencias) const {
+    // Generar Tabla de Símbolos
+    ostringstream sym;
+    sym << "Tabla de Símbolos:\n";
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] == SIN_DEFINIR) continue;
+        sym << simbolos.nombre(id) << " -> " << direccion_simbolo(id) << '\n';
+    }
+    texto_simbolos = sym.str();
 
     // Generar Tabla de Referencias Pendientes
-    ofstream refs("referencias.txt");
-    refs << "Tabla de Referencias Pendientes:" << endl;
-    for (const auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        const auto& lista = par.second;
-        for (const auto& ref : lista) {
-            refs << "Etiqueta: " << etiqueta
-                 << ", Posicion: " << ref.posicion
-                 << ", Tamano: " << ref.tamano_inmediato
-                 << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO")
-                 << endl;
-        }
-    }
-    refs.close();
-}
-
-// -----------------------------------------------------------------------------
-// 🧪 main de prueba
-// -----------------------------------------------------------------------------
-
-int main() {
-    // 1. Crear un archivo ASM de ejemplo
-    ofstream asm_file("programa.asm");
-    asm_file << "SECTION .TEXT" << endl;
-    asm_file << "GLOBAL _START" << endl;
-    asm_file << "_START:" << endl;
-    asm_file << "MOV EAX, 1" << endl;           // B8 01 00 00 00
-    asm_file << "MOV EBX, 0" << endl;           // BB 00 00 00 00
-    asm_file << "CALL ETIQUETA_LL" << endl;     // (no implementado en este ensamblador, solo ejemplo)
-    asm_file << "SUB EAX, 1H" << endl;          // 2D 01 00 00 00
-    asm_file << "JE ETIQUETA_FIN" << endl;      // 0F 84 xx xx xx xx
-    asm_file << "ETIQUETA_LL:" << endl;
-    asm_file << "MOV EAX, 5H" << endl;
-    asm_file << "SUB EAX, 1H" << endl;
-    asm_file << "JNE ETIQUETA_LL" << endl;
-    asm_file << "ETIQUETA_FIN:" << endl;
-    asm_file << "INT 80H" << endl;
-    asm_file << "SECTION .DATA" << endl;
-    asm_file << "VAR_DATA: DD 0" << endl;
-    asm_file.close();
-
-    // 2. Ejecutar el ensamblador
-    EnsambladorIA32 ensamblador;
-    cout << "Iniciando ensamblado en una sola pasada (EnsambladorIA32.cpp)..." << endl;
-    ensamblador.ensamblar("programa.asm");
-    
-    cout << "Resolviendo referencias pendientes..." << endl;
-    ensamblador.resolver_referencias_pendientes();
-    
-    cout << "Generando código hexadecimal y reportes..." << endl;
-    ensamblador.generar_hex("programa.hex");
-    ensamblador.generar_reportes();
-    
-    cout << "Proceso completado. Revise programa.hex, simbolos.txt y referencias.txt" << endl;
-
-    return 0;
+    ostringstream refs;
+    // Posiciones en la imagen plana: las de .data van tras .text
+    refs << "Tabla de Referencias Pendientes:\n";
+    auto listar = [&](const vector<ReferenciaPendiente>& referencias, uint32_t base) {
+        for (const auto& ref : referencias) {
+            refs << "Etiqueta: " << simbolos.nombre(ref.simbolo)
+                 << ", Posicion: " << base + ref.posicion
+                 << ", Tamano: " << static_cast<int>(ref.tamano_inmediato)
+                 << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO");
+            if (ref.sumando != 0) refs << ", Sumando: " << ref.sumando;
+            refs << '\n';
+        }
+    };
+    listar(referencias_pendientes, 0);
+    listar(secciones[static_cast<int>(SeccionELF::DATOS)].referencias, base_seccion(SeccionELF::DATOS));
+    texto_referencias = refs.str();
+}
+
+bool EnsambladorIA32::construir_salida(const string& formato, string& salida) {
+    if (formato == "bin") {
+        const vector<uint8_t>& plana = salida_plana();
+        salida.assign(plana.begin(), plana.end());
+        return true;
+    }
+    if (formato == "elf" || formato == "exe") {
+        vector<uint8_t> imagen;
+        if (!construir_elf(formato == "exe", imagen)) return false;
+        salida.assign(imagen.begin(), imagen.end());
+        return true;
+    }
+    formatear_hex(salida_plana(), salida);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// 📊 Estadísticas
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::activar_estadisticas(bool activas) {
+    estadisticas.activar(activas);
+}
+
+const EstadisticasEnsamblado& EnsambladorIA32::consultar_estadisticas() {
+    estadisticas.bytes_codigo = static_cast<uint64_t>(base_continua) + codigo_hex.size();
+    estadisticas.actualizar_asignaciones();
+    return estadisticas;
+}
+
+// -----------------------------------------------------------------------------
+// 🔌 Uso embebido
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::reiniciar() {
+    contador_posicion = 0;
+    simbolos.limpiar();
+    tabla_simbolos.clear();
+    simbolos_globales.clear();
+    referencias_pendientes.clear();
+    codigo_hex.clear();
+    saltos_relajables.clear();
+    ventana.clear();
+    optimizaciones = InformeOptimizacion();
+    alineacion_maxima = 1;
+    instrucciones_analisis.clear();
+    etiquetas_analisis.clear();
+    directorio_fuente.clear();
+    pila_inclusion.clear();
+    dependencias.clear();
+    base_continua = 0;
+    seccion_actual = SeccionELF::TEXTO;
+    secciones_simbolos.clear();
+    for (ContenidoSeccion& seccion : secciones) {
+        // clear() y no un ContenidoSeccion nuevo: se conserva la capacidad
+        seccion.codigo.clear();
+        seccion.posicion = 0;
+        seccion.referencias.clear();
+        seccion.saltos.clear();
+    }
+    alineacion_datos = 4;
+    imagen_plana.clear();
+    estadisticas.limpiar();
+}
+
+VistaBytes EnsambladorIA32::ensamblar_en_memoria(string_view fuente) {
+    reiniciar();
+    ensamblar_texto_fuente(fuente);
+    resolver_referencias_pendientes();
+    return codigo_generado();
+}
+
+bool EnsambladorIA32::buscar_simbolo(string_view nombre, uint32_t& direccion) const {
+    uint32_t id = simbolos.buscar(nombre);
+    if (id == InternadorSimbolos::NINGUNO || tabla_simbolos[id] == SIN_DEFINIR) return false;
+    direccion = direccion_simbolo(id);
+    return true;
+}
+
+void EnsambladorIA32::simbolos_codigo(vector<SimboloCodigo>& salida) const {
+    salida.clear();
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (posicion_texto(id) == SIN_DEFINIR) continue;
+        salida.push_back({simbolos.nombre(id), static_cast<uint32_t>(tabla_simbolos[id]), 0,
+                          static_cast<bool>(simbolos_globales[id])});
+    }
+    stable_sort(salida.begin(), salida.end(),
+                [](const SimboloCodigo& a, const SimboloCodigo& b) { return a.inicio < b.inicio; });
+
+    // Varias etiquetas en la misma posición son alias: todas llegan hasta la
+    // siguiente posición con etiqueta
+    uint32_t siguiente = static_cast<uint32_t>(codigo_hex.size());
+    for (size_t i = salida.size(); i-- > 0;) {
+        if (i + 1 < salida.size() && salida[i + 1].inicio != salida[i].inicio) siguiente = salida[i + 1].inicio;
+        salida[i].tamano = siguiente - salida[i].inicio;
+    }
+}
+
+size_t EnsambladorIA32::emitir_en(uint8_t* destino, size_t capacidad, uint32_t origen) const {
+    const vector<uint8_t>& plana = salida_plana();
+    if (plana.size() > capacidad) return 0;
+    memcpy(destino, plana.data(), plana.size());
+
+    // Las referencias relativas no dependen del origen; las absolutas a
+    // etiquetas propias se trasladan (las indefinidas quedan como están)
+    if (origen != 0) {
+        auto trasladar = [&](const vector<ReferenciaPendiente>& referencias, uint32_t base) {
+            for (const auto& ref : referencias) {
+                if (ref.tipo_salto != 0 || ref.tamano_inmediato != 4) continue;
+                if (tabla_simbolos[ref.simbolo] == SIN_DEFINIR) continue;
+                uint32_t valor;
+                memcpy(&valor, destino + base + ref.posicion, 4);
+                valor += origen;
+                memcpy(destino + base + ref.posicion, &valor, 4);
+            }
+        };
+        trasladar(referencias_pendientes, 0);
+        trasladar(secciones[static_cast<int>(SeccionELF::DATOS)].referencias, base_seccion(SeccionELF::DATOS));
+    }
+    return plana.size();
+}
+
+// -----------------------------------------------------------------------------
+// 🔬 Optimización de mirilla
+// -----------------------------------------------------------------------------
+
+namespace {
+    constexpr size_t TAMANO_VENTANA = 4; // Instrucciones que se miran por delante
+
+    bool es_mov_registros(const InstruccionIR& ins) {
+        return ins.mnem == Mnemonico::MOV && ins.total_ops == 2 &&
+               (ins.ops[0].tipo == TipoOperando::REG32 || ins.ops[0].tipo == TipoOperando::REG8) &&
+               ins.ops[1].tipo == ins.ops[0].tipo;
+    }
+
+    bool es_reg32_inmediato(const InstruccionIR& ins) {
+        return ins.total_ops == 2 && ins.ops[0].tipo == TipoOperando::REG32 &&
+               ins.ops[1].tipo == TipoOperando::INMEDIATO;
+    }
+}
+
+bool EnsambladorIA32::banderas_muertas_tras(size_t indice) const {
+    // Las banderas de la instrucción 'indice' no se leen si, antes de cualquier
+    // lectura o salto, otra instrucción de la ventana las redefine todas. Más
+    // allá de la ventana no se sabe: se asume que se leen
+    for (size_t i = indice + 1; i < ventana.size(); ++i) {
+        switch (efecto_banderas(ventana[i].mnem)) {
+            case EfectoBanderas::NINGUNO: continue;
+            case EfectoBanderas::ESCRIBE: return true;
+            default: return false;
+        }
+    }
+    return false;
+}
+
+void EnsambladorIA32::encolar_instruccion(const InstruccionIR& ins) {
+    // MOV r, r y MOV b, a justo después de MOV a, b no cambian nada
+    if (es_mov_registros(ins)) {
+        if (ins.ops[0].reg == ins.ops[1].reg) {
+            ++optimizaciones.movs_redundantes;
+            return;
+        }
+        if (!ventana.empty() && es_mov_registros(ventana.back())) {
+            const InstruccionIR& previa = ventana.back();
+            if (previa.ops[0].tipo == ins.ops[0].tipo &&
+                previa.ops[0].reg == ins.ops[1].reg && previa.ops[1].reg == ins.ops[0].reg) {
+                ++optimizaciones.movs_redundantes;
+                return;
+            }
+        }
+    }
+
+    ventana.push_back(ins);
+    if (ventana.size() > TAMANO_VENTANA) emitir_primera_de_ventana();
+}
+
+void EnsambladorIA32::emitir_primera_de_ventana() {
+    InstruccionIR& ins = ventana.front();
+
+    // Reescrituras más cortas que cambian las banderas: sólo si nadie las lee
+    if (es_reg32_inmediato(ins) && banderas_muertas_tras(0)) {
+        const int32_t inmediato = static_cast<int32_t>(ins.ops[1].valor);
+        InstruccionIR nueva = ins;
+        nueva.mnem = Mnemonico::DESCONOCIDO;
+        if (ins.mnem == Mnemonico::MOV && inmediato == 0) {
+            // MOV r32, 0 (5 bytes) -> XOR r32, r32 (2 bytes)
+            nueva.mnem = Mnemonico::XOR;
+            nueva.ops[1] = nueva.ops[0];
+        } else if ((ins.mnem == Mnemonico::ADD || ins.mnem == Mnemonico::SUB) &&
+                   (inmediato == 1 || inmediato == -1)) {
+            // ADD/SUB r32, ±1 (3 bytes) -> INC/DEC r32 (1 byte); INC/DEC no tocan CF
+            nueva.mnem = (ins.mnem == Mnemonico::ADD) == (inmediato == 1) ? Mnemonico::INC : Mnemonico::DEC;
+            nueva.total_ops = 1;
+        }
+
+        if (nueva.mnem != Mnemonico::DESCONOCIDO) {
+            nueva.forma = buscar_forma(nueva.mnem, nueva.ops, nueva.total_ops);
+            if (nueva.forma) {
+                if (nueva.mnem == Mnemonico::XOR) ++optimizaciones.mov_cero_a_xor;
+                else ++optimizaciones.suma_uno_a_inc;
+                ins = nueva;
+            }
+        }
+    }
+
+    emitir_instruccion(ins);
+    ventana.erase(ventana.begin());
+}
+
+void EnsambladorIA32::vaciar_ventana() {
+    while (!ventana.empty()) emitir_primera_de_ventana();
+}
+
+// -----------------------------------------------------------------------------
+// 📈 Análisis de rendimiento
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::registrar_para_analisis(const InstruccionIR& ins, int posicion) {
+    InstruccionAnalizada a;
+    a.mnem = ins.mnem;
+    a.total_ops = ins.total_ops;
+    a.regs_direccion = 0;
+    a.clave_memoria = 0;
+    a.destino = InternadorSimbolos::NINGUNO;
+    a.posicion = posicion;
+
+    for (int k = 0; k < 3; ++k) {
+        const Operando& op = ins.ops[k];
+        a.reg[k] = 0;
+        a.clase[k] = ClaseOperando::NINGUNO;
+        if (k >= ins.total_ops) continue;
+
+        switch (op.tipo) {
+            case TipoOperando::REG32:
+                a.clase[k] = ClaseOperando::REGISTRO;
+                a.reg[k] = op.reg;
+                break;
+            case TipoOperando::REG8:
+                a.clase[k] = ClaseOperando::REGISTRO;
+                a.reg[k] = op.reg & 3; // AL/AH -> EAX, CL/CH -> ECX, ...
+                break;
+            case TipoOperando::XMM:
+                a.clase[k] = ClaseOperando::REGISTRO;
+                a.reg[k] = PRIMER_REGISTRO_XMM + op.reg;
+                break;
+            case TipoOperando::MEMORIA: {
+                a.clase[k] = ClaseOperando::MEMORIA;
+                if (op.base != Operando::SIN_REGISTRO) a.regs_direccion |= 1u << op.base;
+                if (op.indice != Operando::SIN_REGISTRO) a.regs_direccion |= 1u << op.indice;
+                // La clave usa el nombre de la etiqueta (no su ID) para que
+                // coincida entre fragmentos ensamblados en paralelo
+                uint64_t h = 14695981039346656037ull;
+                for (char c : op.simbolo) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+                const uint64_t resto[] = {op.base, op.indice, op.escala, static_cast<uint64_t>(op.valor)};
+                for (uint64_t v : resto) h = (h ^ v) * 1099511628211ull;
+                a.clave_memoria = h;
+                break;
+            }
+            case TipoOperando::INMEDIATO:
+                a.clase[k] = ClaseOperando::INMEDIATO;
+                break;
+            case TipoOperando::ETIQUETA:
+                a.clase[k] = ClaseOperando::ETIQUETA;
+                a.destino = id_simbolo(op.simbolo);
+                break;
+            default:
+                break;
+        }
+    }
+    instrucciones_analisis.push_back(a);
+}
+
+void EnsambladorIA32::quitar_de_analisis(const vector<pair<int, int>>& tramos, bool con_etiquetas) {
+    // Quita las instrucciones que empiezan en los tramos [inicio, fin)
+    // (ordenados y disjuntos) y traslada las demás como el código. Con
+    // 'con_etiquetas' también las etiquetas de los tramos, que eran código
+    // muerto; sin él se quedan en la instrucción siguiente
+    vector<uint32_t> nuevo_indice(instrucciones_analisis.size() + 1);
+    size_t n = 0, k = 0;
+    int quitados = 0;
+    for (size_t i = 0; i < instrucciones_analisis.size(); ++i) {
+        nuevo_indice[i] = static_cast<uint32_t>(n);
+        InstruccionAnalizada ins = instrucciones_analisis[i];
+        while (k < tramos.size() && tramos[k].second <= ins.posicion) {
+            quitados += tramos[k].second - tramos[k].first;
+            ++k;
+        }
+        if (k < tramos.size() && tramos[k].first <= ins.posicion) continue;
+        ins.posicion -= quitados;
+        instrucciones_analisis[n++] = ins;
+    }
+    nuevo_indice.back() = static_cast<uint32_t>(n);
+    instrucciones_analisis.resize(n);
+
+    size_t m = 0;
+    for (EtiquetaAnalizada etiqueta : etiquetas_analisis) {
+        if (con_etiquetas) {
+            const int posicion = tabla_simbolos[etiqueta.simbolo];
+            auto it = upper_bound(tramos.begin(), tramos.end(), make_pair(posicion, INT_MAX));
+            if (it != tramos.begin() && posicion < prev(it)->second) continue;
+        }
+        etiqueta.instruccion = nuevo_indice[etiqueta.instruccion];
+        etiquetas_analisis[m++] = etiqueta;
+    }
+    etiquetas_analisis.resize(m);
+}
+
+void EnsambladorIA32::generar_analisis(ostream& os) const {
+    escribir_analisis_rendimiento(instrucciones_analisis, etiquetas_analisis, simbolos, os);
+}
+
+void EnsambladorIA32::generar_analisis(const string& archivo_salida) const {
+    ofstream archivo(archivo_salida);
+    if (!archivo) {
+        *diagnosticos << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return;
+    }
+    generar_analisis(archivo);
 }
@@ -10,60 +10,446 @@
 #include <algorithm>
 #include <iomanip>
 #include <cstdint>
+#include <memory>
+
+#include "TablaOpcodes.hpp"
+#include "LectorFuente.hpp"
+#include "EscanerLineas.hpp"
+#include "InternadorSimbolos.hpp"
+#include "PoolHilos.hpp"
+#include "SalidaBinaria.hpp"
+#include "Estadisticas.hpp"
+#include "AnalisisRendimiento.hpp"
 
 using namespace std;
 
 // --- ESTRUCTURAS DE DATOS ---
-// Estructura para almacenar una referencia pendiente
+// Referencia pendiente: registro compacto (16 bytes) guardado en un único
+// arreglo ordenado por posición
 struct ReferenciaPendiente {
-    int posicion;           // Posición en codigo_hex donde se necesita el parche
-    int tamano_inmediato;   // 1 o 4 (byte o dword para el desplazamiento)
-    int tipo_salto;         // 0: Absoluto (dirección de etiqueta), 1: Relativo (dirección de salto)
+    uint32_t posicion;          // Posición en codigo_hex donde se necesita el parche
+    uint32_t simbolo;           // ID de la etiqueta (InternadorSimbolos)
+    int32_t sumando;            // Desplazamiento añadido a la etiqueta ([ETIQUETA+DISP])
+    uint8_t tamano_inmediato;   // 1 o 4 (byte o dword para el desplazamiento)
+    uint8_t tipo_salto;         // 0: Absoluto (dirección de etiqueta), 1: Relativo (dirección de salto)
+};
+
+// Salto cuyo tamaño (rel8 o rel32) se decide al final, en la relajación. Con
+// 'alineacion' > 0 es en cambio un punto de ALIGN: no ocupa nada en codigo_hex
+// y la relajación le da el relleno de NOPs que toque según dónde quede.
+struct SaltoRelajable {
+    int posicion;           // Inicio de la instrucción en codigo_hex (emitida en forma corta)
+    bool condicional;       // Jcc (true) o JMP (false)
+    uint8_t condicion;      // Código de condición cc de Jcc (0x0..0xF)
+    bool largo;             // true si el desplazamiento no cabe en rel8
+    bool eliminado;         // Salto a la instrucción siguiente quitado por la optimización
+    int destino;            // Posición de la etiqueta antes de relajar (-1 si no está definida)
+    uint32_t simbolo;       // ID de la etiqueta destino
+    int32_t sumando;        // Desplazamiento añadido al destino (JMP ETIQUETA+N)
+    uint16_t alineacion;        // ALIGN: potencia de dos (0 en los saltos)
+    uint16_t relleno_maximo;    // ALIGN: si hace falta más relleno, no se alinea
+    uint16_t relleno;           // ALIGN: bytes de NOP que lleva tras la relajación
+};
+
+// Contenido de una sección: bytes (ninguno en .bss), tamaño, referencias y
+// saltos en orden de posición. En .data y .bss los "saltos" son sólo puntos
+// de ALIGN, que se rellenan con ceros al resolver.
+struct ContenidoSeccion {
+    vector<uint8_t> codigo;
+    int posicion = 0;
+    vector<ReferenciaPendiente> referencias;
+    vector<SaltoRelajable> saltos;
+};
+
+// Alineación automática de las cabeceras de bucle (etiquetas destino de un
+// salto hacia atrás), como un ALIGN implícito delante de cada una
+struct AlineacionBucles {
+    uint16_t alineacion = 0;        // Potencia de dos; 0 = desactivada
+    uint16_t relleno_maximo = 0;    // Bytes de relleno como mucho
+};
+
+// Clase de un operando ya analizado
+enum class TipoOperando : uint8_t {
+    NINGUNO,
+    REG32,      // EAX..EDI
+    REG8,       // AL..BH
+    XMM,        // XMM0..XMM7
+    MEMORIA,    // [BASE + INDICE*ESCALA + DESPLAZAMIENTO], con etiqueta opcional
+    INMEDIATO,  // Número
+    ETIQUETA    // Identificador suelto (destino de salto o dirección)
+};
+
+// Operando de una instrucción
+struct Operando {
+    static constexpr uint8_t SIN_REGISTRO = 0xFF;
+
+    TipoOperando tipo = TipoOperando::NINGUNO;
+    uint8_t reg = 0;        // Código del registro (REG32/REG8/XMM)
+    uint8_t tamano = 0;     // Tamaño explícito en memoria (BYTE=1, DWORD=4, OWORD=16, 0 = sin indicar)
+    uint8_t base = SIN_REGISTRO;    // Memoria: registro base
+    uint8_t indice = SIN_REGISTRO;  // Memoria: registro índice
+    uint8_t escala = 1;             // Memoria: 1, 2, 4 u 8
+    int64_t valor = 0;      // Inmediato o desplazamiento (sumando si hay símbolo)
+    string_view simbolo;    // Etiqueta referenciada (vista sobre la línea; vacía si no hay)
+};
+
+// Instrucción ya analizada y con su forma elegida, antes de codificarse.
+// Los operandos son vistas sobre el texto fuente: sólo viven mientras se
+// ensambla ese texto.
+struct InstruccionIR {
+    Mnemonico mnem;
+    const FormaInstruccion* forma;
+    Operando ops[3];
+    uint8_t total_ops;
+};
+
+// Cambios hechos por la optimización de mirilla (-O)
+struct InformeOptimizacion {
+    uint64_t mov_cero_a_xor = 0;        // MOV r32, 0        -> XOR r32, r32
+    uint64_t suma_uno_a_inc = 0;        // ADD/SUB r32, ±1   -> INC/DEC r32
+    uint64_t movs_redundantes = 0;      // MOV a, b / MOV b, a y MOV r, r eliminados
+    uint64_t saltos_al_siguiente = 0;   // JMP/Jcc a la instrucción siguiente eliminados
+
+    // Grafo de flujo (-O2), sobre el programa ya enlazado
+    uint64_t saltos_encadenados = 0;    // Salto a JMP -> salto al destino final
+    uint64_t saltos_invertidos = 0;     // Jcc A / JMP B / A: -> J!cc B
+    uint64_t bloques_muertos = 0;       // Bloques inalcanzables quitados
+    uint64_t bytes_muertos = 0;
+
+    uint64_t total() const {
+        return mov_cero_a_xor + suma_uno_a_inc + movs_redundantes + saltos_al_siguiente +
+               saltos_encadenados + saltos_invertidos + bloques_muertos;
+    }
+    void acumular(const InformeOptimizacion& otro) {
+        mov_cero_a_xor += otro.mov_cero_a_xor;
+        suma_uno_a_inc += otro.suma_uno_a_inc;
+        movs_redundantes += otro.movs_redundantes;
+        saltos_al_siguiente += otro.saltos_al_siguiente;
+        saltos_encadenados += otro.saltos_encadenados;
+        saltos_invertidos += otro.saltos_invertidos;
+        bloques_muertos += otro.bloques_muertos;
+        bytes_muertos += otro.bytes_muertos;
+    }
+};
+
+// Vista de sólo lectura sobre bytes de código (equivalente a span<const uint8_t>)
+struct VistaBytes {
+    const uint8_t* datos = nullptr;
+    size_t tamano = 0;
+
+    const uint8_t* data() const { return datos; }
+    size_t size() const { return tamano; }
+    bool empty() const { return tamano == 0; }
+    const uint8_t* begin() const { return datos; }
+    const uint8_t* end() const { return datos + tamano; }
+    uint8_t operator[](size_t i) const { return datos[i]; }
+};
+
+// Etiqueta del código ya resuelto, para perfiladores y depuradores. El
+// nombre apunta al internador del ensamblador: vale hasta el siguiente
+// reiniciar() o ensamblado.
+struct SimboloCodigo {
+    string_view nombre;
+    uint32_t inicio;    // Desplazamiento desde el origen del código
+    uint32_t tamano;    // Hasta la siguiente etiqueta en otra posición (o el final)
+    bool global;
+};
+
+// Versión del ensamblador: forma parte de la clave de las cachés en disco
+// (módulos y salidas), así que debe cambiar con cualquier cambio de codificación
+constexpr const char VERSION_ENSAMBLADOR[] = "0.23.0";
+
+// Archivo incluido con %include y hash de su contenido al ensamblarlo
+struct DependenciaModulo {
+    string ruta;            // Ruta canónica
+    uint64_t hash;
+};
+
+class CacheModulos;
+
+// Resultado autónomo de codificar un trozo de fuente desde la posición 0:
+// código previo a la relajación, símbolos por nombre (IDs locales) y
+// diagnósticos. Es la unidad de la caché del ensamblado incremental.
+struct FragmentoCodificado {
+    vector<uint8_t> codigo;                 // .text
+    string nombres;                         // Nombres concatenados
+    vector<uint32_t> fin_nombres;           // ID local -> fin de su nombre en 'nombres'
+    vector<int32_t> posiciones;             // ID local -> posición relativa o SIN_DEFINIR
+    vector<bool> globales;                  // ID local -> GLOBAL/EXTERN
+    vector<SeccionELF> secciones_simbolos;  // ID local -> sección donde se definió
+    vector<ReferenciaPendiente> referencias;
+    vector<SaltoRelajable> saltos;
+    ContenidoSeccion datos, bss;            // Desde la posición 0 de cada sección
+    SeccionELF seccion_final = SeccionELF::TEXTO; // Sección activa al terminar
+    InformeOptimizacion optimizaciones;     // Cambios de la mirilla dentro del bloque
+    string diagnosticos;
+
+    string_view nombre(uint32_t id) const {
+        uint32_t inicio = id == 0 ? 0 : fin_nombres[id - 1];
+        return string_view(nombres).substr(inicio, fin_nombres[id] - inicio);
+    }
 };
 
 class EnsambladorIA32 {
+    friend class EnsambladoIncremental;
+
+public:
+    static constexpr int32_t SIN_DEFINIR = -1;
+
 private:
     int contador_posicion; // Contador de posición (CP)
-    unordered_map<string, int> tabla_simbolos; // Etiqueta -> Dirección (CP)
-    unordered_map<string, vector<ReferenciaPendiente>> referencias_pendientes; // Etiqueta -> Lista de refs
+    InternadorSimbolos simbolos; // Nombre de etiqueta -> ID denso
+    vector<int32_t> tabla_simbolos; // ID -> Dirección (CP) en su sección; SIN_DEFINIR si aún no aparece
+    vector<bool> simbolos_globales; // ID -> declarado con GLOBAL/EXTERN
+    vector<SeccionELF> secciones_simbolos; // ID -> sección de la etiqueta (.text si no está definida)
+    vector<ReferenciaPendiente> referencias_pendientes; // Ordenadas por posición
     vector<uint8_t> codigo_hex; // Código máquina generado
+    vector<SaltoRelajable> saltos_relajables; // Saltos emitidos en forma corta, en orden de posición
+    ostream* diagnosticos; // Destino de errores y advertencias (cerr por defecto)
+
+    // Secciones: contador_posicion, codigo_hex, referencias_pendientes y
+    // saltos_relajables son siempre los de la sección activa; las demás
+    // esperan en 'secciones' (la casilla de la activa queda vacía). Tras
+    // resolver, la activa es .text e imagen_plana guarda la salida plana
+    // (.text, .data alineada detrás) si hay datos.
+    SeccionELF seccion_actual;
+    ContenidoSeccion secciones[4];          // Por SeccionELF
+    uint16_t alineacion_datos;              // De .data y .bss: 4 o el mayor ALIGN
+    vector<uint8_t> imagen_plana;
+
+    // Búferes de trabajo de la relajación y la resolución: se conservan entre
+    // ensamblados para no reservar memoria en cada uno
+    vector<uint8_t> codigo_relajado;
+    vector<int> crecimiento_acumulado;
+    vector<ReferenciaPendiente> referencias_saltos;
+    vector<bool> avisados;
+    EstadisticasEnsamblado estadisticas; // Tiempos y contadores por etapa (desactivadas por defecto)
+
+    // Optimización de mirilla: las instrucciones esperan en una ventana corta
+    // antes de codificarse para poder reescribirlas o quitarlas
+    bool optimizar;
+    bool optimizar_flujo;   // -O2: pasada del grafo de flujo antes de relajar
+    vector<InstruccionIR> ventana;
+    InformeOptimizacion optimizaciones;
+
+    // Alineación: la de las cabeceras de bucle y la mayor pedida, que pasa a
+    // ser la de .text en el ELF
+    AlineacionBucles alineacion_bucles;
+    uint16_t alineacion_maxima;
+
+    // Registro de lo emitido para el análisis de rendimiento (desactivado por defecto)
+    bool analizar;
+    vector<InstruccionAnalizada> instrucciones_analisis;
+    vector<EtiquetaAnalizada> etiquetas_analisis;
 
-    unordered_map<string, uint8_t> reg32_map; // Códigos de 32-bit (EAX=0, ECX=1, ...)
-    unordered_map<string, uint8_t> reg8_map;  // Códigos de 8-bit
+    // %include: módulos ya codificados (compartidos con otros ensambladores),
+    // archivos en curso para detectar ciclos y todos los archivos incluidos
+    shared_ptr<CacheModulos> modulos;
+    string directorio_fuente;               // Base de las rutas relativas ("" = directorio actual)
+    vector<string> pila_inclusion;
+    vector<DependenciaModulo> dependencias;
+
+    // Salida continua (--stream): codigo_hex es sólo la ventana que empieza
+    // en base_continua y referencias_pendientes, sólo las de la ventana. Al
+    // volcarla, las que aún no tienen etiqueta pasan a una lista enlazada por
+    // símbolo, que se vacía cuando la etiqueta aparece.
+    struct ParcheContinuo {
+        ReferenciaPendiente ref;
+        uint32_t siguiente;     // Siguiente nodo de la lista (SIN_PARCHE al final)
+    };
+    static constexpr uint32_t SIN_PARCHE = 0xFFFFFFFFu;
+    SalidaContinua* salida_continua;            // nullptr fuera de ensamblar_continuo
+    int base_continua;
+    vector<ParcheContinuo> parches_continuos;   // Nodos de las listas y libres
+    vector<uint32_t> primer_parche;             // ID -> primer nodo de su lista
+    uint32_t parche_libre;                      // Primer nodo libre
+
+    // Registros indexados por vista, sin distinguir mayúsculas
+    using MapaRegistros = unordered_map<string_view, uint8_t, HashSinMayusculas, IgualSinMayusculas>;
+    MapaRegistros reg32_map; // Códigos de 32-bit (EAX=0, ECX=1, ...)
+    MapaRegistros reg8_map;  // Códigos de 8-bit
+    MapaRegistros xmm_map;   // Códigos de XMM0..XMM7
 
     // --- MÉTODOS AUXILIARES ---
     void inicializar_mapas();
-    void limpiar_linea(string& linea);
-    bool es_etiqueta(const string& s);
+    void limpiar_linea(string_view& linea);
+    bool es_etiqueta(string_view s);
+
+    void ensamblar_texto(string_view texto);
+    void ensamblar_texto_medido(string_view texto);
+    void enlazar_fragmento(const EnsambladorIA32& fragmento, SeccionELF seccion_final);
+    void extraer_fragmento(FragmentoCodificado& fragmento);
+    void enlazar_codificado(const FragmentoCodificado& fragmento);
+    static bool es_frontera_segura(const LineaEscaneada& linea);
+    static bool seccion_de_linea(const LineaEscaneada& linea, SeccionELF& seccion);
+
+    void procesar_linea(const LineaEscaneada& linea);
+    void procesar_etiqueta(string_view etiqueta);
+    void procesar_instruccion(string_view linea, size_t fin_mnem);
+    void procesar_directiva(Mnemonico directiva, string_view operandos);
+    void procesar_align(string_view operandos);
+    void incluir_archivo(string_view operandos);
+    void fijar_origen(const string& archivo_entrada);
+
+    // --- SECCIONES Y DATOS ---
+    void seleccionar_seccion(SeccionELF seccion);
+    void procesar_seccion(string_view operandos);
+    void procesar_datos(Mnemonico directiva, string_view operandos);
+    void procesar_reserva(Mnemonico directiva, string_view operandos);
+    void procesar_times(string_view operandos);
+    void incluir_binario(string_view operandos);
+    bool datos_en_bss(Mnemonico directiva);
+    void alinear_seccion(SeccionELF seccion);
+    int tamano_seccion(SeccionELF seccion) const;
+    uint32_t base_seccion(SeccionELF seccion) const;
+    // Posición de una etiqueta de .text (SIN_DEFINIR si no lo es) y dirección
+    // de cualquier etiqueta definida en la imagen plana
+    int32_t posicion_texto(uint32_t id) const {
+        return secciones_simbolos[id] == SeccionELF::TEXTO ? tabla_simbolos[id] : SIN_DEFINIR;
+    }
+    uint32_t direccion_simbolo(uint32_t id) const {
+        const SeccionELF seccion = secciones_simbolos[id];
+        return (seccion == SeccionELF::TEXTO ? 0 : base_seccion(seccion)) + static_cast<uint32_t>(tabla_simbolos[id]);
+    }
+    void avisar_no_definida(uint32_t id);
+    void resolver_referencias_datos();
+    const vector<uint8_t>& salida_plana() const { return imagen_plana.empty() ? codigo_hex : imagen_plana; }
+
+    // --- SELECCIÓN DE FORMA (tabla de opcodes) ---
+    bool analizar_operando(string_view texto, Operando& op);
+    bool analizar_inmediato(string_view texto, int64_t& valor);
+    bool analizar_simbolo(string_view texto, string_view& simbolo, int64_t& sumando);
+    bool analizar_memoria(string_view interior, Operando& op);
+    bool operando_encaja(const Operando& op, FormaOperando forma);
+    const FormaInstruccion* buscar_forma(Mnemonico mnem, const Operando* ops, int total_ops);
+    void codificar(const FormaInstruccion& forma, const Operando* ops);
+    void emitir_instruccion(const InstruccionIR& ins);
+
+    // --- OPTIMIZACIÓN DE MIRILLA ---
+    void encolar_instruccion(const InstruccionIR& ins);
+    void vaciar_ventana();
+    void emitir_primera_de_ventana();
+    bool banderas_muertas_tras(size_t indice) const;
 
-    void procesar_linea(string linea);
-    void procesar_etiqueta(const string& etiqueta);
-    void procesar_instruccion(const string& linea);
+    void registrar_para_analisis(const InstruccionIR& ins, int posicion);
+    void quitar_de_analisis(const vector<pair<int, int>>& tramos, bool con_etiquetas);
 
-    void procesar_mov(const string& operandos);
-    void procesar_add(const string& operandos);
-    void procesar_sub(const string& operandos);
-    void procesar_jmp(string operandos); // por valor para poder limpiarla
-    void procesar_condicional(const string& mnem, string operandos); // por valor para poder limpiarla
+    void procesar_jmp(string_view etiqueta, int32_t sumando);
+    void procesar_condicional(uint8_t opcode_byte2, string_view etiqueta, int32_t sumando);
+    void optimizar_grafo_flujo();
+    void relajar_saltos();
+    void marcar_cabeceras_bucle();
+    int crecimiento_antes(int posicion);
+
+    // --- SALIDA CONTINUA ---
+    void volcar_ventana_continua();
+    void resolver_parches_continuos(uint32_t simbolo);
+    void emitir_salto_continuo(bool condicional, uint8_t condicion, string_view etiqueta, int32_t sumando);
+    void alinear_continuo(uint16_t alineacion, uint16_t relleno_maximo);
 
     // --- UTILIDADES DE CODIFICACIÓN ---
     uint8_t generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm);
     void agregar_byte(uint8_t byte);
+    void agregar_word(uint16_t word);   // Para RET imm16
     void agregar_dword(uint32_t dword); // Para inmediatos y desplazamientos de 32 bits
-    bool obtener_reg32(const string& op, uint8_t& reg_code);
-    bool procesar_mem_simple(const string& operando,
-                             uint8_t& modrm_byte,
-                             const uint8_t reg_code,
-                             bool es_destino,
-                             uint8_t op_extension = 0);
+    void agregar_bloque(const uint8_t* datos, size_t n); // Datos, INCBIN: una sola copia
+    void agregar_inmediato(const Operando& op, int tamano);
+    void registrar_referencia(string_view etiqueta, int tamano, int tipo_salto, int32_t sumando);
+    uint32_t id_simbolo(string_view etiqueta);
+    bool obtener_reg32(string_view op, uint8_t& reg_code);
+    bool obtener_reg8(string_view op, uint8_t& reg_code);
+    bool obtener_xmm(string_view op, uint8_t& reg_code);
+    bool codificar_memoria(const Operando& operando, uint8_t reg_field);
+    void agregar_desplazamiento(const Operando& operando, int tamano);
 
 public:
     EnsambladorIA32();
 
     void ensamblar(const string& archivo_entrada);
+    // Ensambla desde memoria; el texto sólo tiene que vivir durante la llamada
+    void ensamblar_texto_fuente(string_view fuente);
+    // Divide la entrada en fragmentos, los codifica en paralelo y los enlaza;
+    // el resultado es idéntico al de ensamblar(). hilos = 0: todos los núcleos
+    void ensamblar_paralelo(const string& archivo_entrada, unsigned hilos = 0);
     void resolver_referencias_pendientes();
     void generar_hex(const string& archivo_salida);
-    void generar_reportes();
+    void generar_binario(const string& archivo_salida);
+    void generar_elf(const string& archivo_salida, bool ejecutable);
+    bool construir_elf(bool ejecutable, vector<uint8_t>& salida);
+    void generar_reportes(const string& archivo_simbolos = "simbolos.txt",
+                          const string& archivo_referencias = "referencias.txt");
+
+    // Contenido de la salida (hex, bin, elf o exe) y de los reportes, sin
+    // escribir archivos
+    bool construir_salida(const string& formato, string& salida);
+    void construir_reportes(string& texto_simbolos, string& texto_referencias) const;
+
+    // --- SALIDA CONTINUA (--stream) ---
+    // Ensambla escribiendo la salida ("bin" o "hex") por bloques a medida que
+    // se completan: la memoria depende de las referencias hacia delante
+    // abiertas, no del tamaño del programa. Sin relajación, los saltos hacia
+    // delante salen siempre en forma larga (rel32); -O2 y la alineación de
+    // bucles no se aplican y los %include se ensamblan en su sitio. Después
+    // codigo() queda vacío, la tabla de símbolos completa y las referencias
+    // pendientes son sólo las no resueltas.
+    bool ensamblar_continuo(const string& archivo_entrada, const string& archivo_salida, const string& formato,
+                            ResumenSalidaContinua* resumen = nullptr);
+
+    // --- USO EMBEBIDO (EN MEMORIA) ---
+    // Vacía el estado para un nuevo ensamblado conservando la capacidad de
+    // todos los búferes y los mapas de registros
+    void reiniciar();
+    // reiniciar + ensamblar_texto_fuente + resolver_referencias_pendientes
+    VistaBytes ensamblar_en_memoria(string_view fuente);
+
+    // Imagen plana ya resuelta: .text y, si hay datos, .data detrás (la .bss
+    // no ocupa bytes). codigo() es sólo .text.
+    VistaBytes codigo_generado() const { return {salida_plana().data(), salida_plana().size()}; }
+    const vector<uint8_t>& codigo() const { return codigo_hex; }
+
+    // Dirección (relativa al origen) de una etiqueta definida, de cualquier sección
+    bool buscar_simbolo(string_view nombre, uint32_t& direccion) const;
+
+    // Etiquetas de .text ordenadas por posición, con su tamaño (para el mapa
+    // de perf y el archivo de símbolos de GDB de SimbolosPerfilado.hpp)
+    void simbolos_codigo(vector<SimboloCodigo>& salida) const;
+
+    // Copia la imagen plana ya resuelta en un búfer del llamador, sumando 'origen' a
+    // las referencias absolutas a etiquetas propias. Devuelve los bytes
+    // escritos, o 0 sin tocar el búfer si no cabe.
+    size_t emitir_en(uint8_t* destino, size_t capacidad, uint32_t origen = 0) const;
+
+    void fijar_diagnosticos(ostream& destino) { diagnosticos = &destino; }
+
+    // --- OPTIMIZACIÓN (-O) ---
+    void activar_optimizacion(bool activa = true) { optimizar = activa; }
+    // -O2: encadenamiento e inversión de saltos y bloques muertos sobre el
+    // programa enlazado. Una etiqueta no GLOBAL a la que sólo se llegue desde
+    // fuera (buscar_simbolo) puede desaparecer con su bloque.
+    void activar_optimizacion_flujo(bool activa = true) { optimizar_flujo = activa; }
+    const InformeOptimizacion& informe_optimizacion() const { return optimizaciones; }
+
+    // --- ALINEACIÓN DE BUCLES ---
+    // Se aplica en la relajación, así que basta con activarla antes de resolver
+    void activar_alineacion_bucles(const AlineacionBucles& bucles) { alineacion_bucles = bucles; }
+
+    // --- MÓDULOS INCLUIDOS ---
+    // Sin caché propia se crea una en memoria en el primer %include
+    void fijar_cache_modulos(shared_ptr<CacheModulos> cache) { modulos = move(cache); }
+    const vector<DependenciaModulo>& archivos_incluidos() const { return dependencias; }
+
+    // --- ANÁLISIS DE RENDIMIENTO ---
+    // Hay que activarlo antes de ensamblar; el informe usa los nombres de las
+    // etiquetas, así que se escribe después de ensamblar (en serie o paralelo)
+    void activar_analisis(bool activo = true) { analizar = activo; }
+    void generar_analisis(ostream& os) const;
+    void generar_analisis(const string& archivo_salida) const;
+
+    // --- ESTADÍSTICAS ---
+    // Activarlas pone los contadores a cero; la consulta completa los totales
+    // (bytes de código, asignaciones) en el momento de llamarla
+    void activar_estadisticas(bool activas = true);
+    const EstadisticasEnsamblado& consultar_estadisticas();
 };
 
 #endif // ENSAMBLADOR_IA32_HPP
@@ -0,0 +1,258 @@
+#include "EscanerLineas.hpp"
+#include "LectorFuente.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ESCANER_X86 1
+#endif
+
+// -----------------------------------------------------------------------------
+// 📌 Clasificación escalar
+// -----------------------------------------------------------------------------
+
+namespace {
+    void clasificar_escalar(const char* p, size_t bloques, MascarasBloque* mascaras) {
+        for (size_t b = 0; b < bloques; ++b, p += 64) {
+            MascarasBloque m{0, 0, 0, 0};
+            for (unsigned i = 0; i < 64; ++i) {
+                const uint64_t bit = 1ull << i;
+                if (p[i] == '\n') m.saltos |= bit;
+                if (p[i] == ';') m.comentarios |= bit;
+                if (p[i] == '\'' || p[i] == '"') m.comillas |= bit;
+                if (es_espacio(p[i])) m.espacios |= bit;
+            }
+            mascaras[b] = m;
+        }
+    }
+
+// -----------------------------------------------------------------------------
+// ⚡ Clasificación SIMD
+// -----------------------------------------------------------------------------
+
+#ifdef ESCANER_X86
+    // es_espacio: ' ' o un byte de '\t' (9) a '\r' (13); c - 9 <= 4 sin signo
+    // se comprueba como min(c - 9, 4) == c - 9
+
+    __attribute__((target("sse2")))
+    void clasificar_sse2(const char* p, size_t bloques, MascarasBloque* mascaras) {
+        const __m128i salto = _mm_set1_epi8('\n');
+        const __m128i comentario = _mm_set1_epi8(';');
+        const __m128i apostrofo = _mm_set1_epi8('\'');
+        const __m128i comilla = _mm_set1_epi8('"');
+        const __m128i espacio = _mm_set1_epi8(' ');
+        const __m128i tabulador = _mm_set1_epi8('\t');
+        const __m128i cuatro = _mm_set1_epi8(4);
+
+        for (size_t b = 0; b < bloques; ++b, p += 64) {
+            MascarasBloque m{0, 0, 0, 0};
+            for (unsigned i = 0; i < 4; ++i) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+                const __m128i d = _mm_sub_epi8(v, tabulador);
+                const __m128i es = _mm_or_si128(_mm_cmpeq_epi8(v, espacio), _mm_cmpeq_epi8(_mm_min_epu8(d, cuatro), d));
+                const unsigned desp = 16 * i;
+                m.saltos |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, salto)))) << desp;
+                m.comentarios |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, comentario)))) << desp;
+                m.espacios |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(es))) << desp;
+                const __m128i entre = _mm_or_si128(_mm_cmpeq_epi8(v, apostrofo), _mm_cmpeq_epi8(v, comilla));
+                m.comillas |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(entre))) << desp;
+            }
+            mascaras[b] = m;
+        }
+    }
+
+    __attribute__((target("avx2")))
+    inline uint64_t mascara(__m256i v) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v)));
+    }
+
+    __attribute__((target("avx2")))
+    void clasificar_avx2(const char* p, size_t bloques, MascarasBloque* mascaras) {
+        const __m256i salto = _mm256_set1_epi8('\n');
+        const __m256i comentario = _mm256_set1_epi8(';');
+        const __m256i apostrofo = _mm256_set1_epi8('\'');
+        const __m256i comilla = _mm256_set1_epi8('"');
+        const __m256i espacio = _mm256_set1_epi8(' ');
+        const __m256i tabulador = _mm256_set1_epi8('\t');
+        const __m256i cuatro = _mm256_set1_epi8(4);
+
+        for (size_t b = 0; b < bloques; ++b, p += 64) {
+            const __m256i bajo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i alto = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+            const __m256i d_bajo = _mm256_sub_epi8(bajo, tabulador);
+            const __m256i d_alto = _mm256_sub_epi8(alto, tabulador);
+            const __m256i es_bajo = _mm256_or_si256(_mm256_cmpeq_epi8(bajo, espacio),
+                                                    _mm256_cmpeq_epi8(_mm256_min_epu8(d_bajo, cuatro), d_bajo));
+            const __m256i es_alto = _mm256_or_si256(_mm256_cmpeq_epi8(alto, espacio),
+                                                    _mm256_cmpeq_epi8(_mm256_min_epu8(d_alto, cuatro), d_alto));
+
+            mascaras[b].saltos = mascara(_mm256_cmpeq_epi8(bajo, salto)) | mascara(_mm256_cmpeq_epi8(alto, salto)) << 32;
+            mascaras[b].comentarios = mascara(_mm256_cmpeq_epi8(bajo, comentario)) |
+                                      mascara(_mm256_cmpeq_epi8(alto, comentario)) << 32;
+            mascaras[b].espacios = mascara(es_bajo) | mascara(es_alto) << 32;
+            mascaras[b].comillas =
+                mascara(_mm256_or_si256(_mm256_cmpeq_epi8(bajo, apostrofo), _mm256_cmpeq_epi8(bajo, comilla))) |
+                mascara(_mm256_or_si256(_mm256_cmpeq_epi8(alto, apostrofo), _mm256_cmpeq_epi8(alto, comilla))) << 32;
+        }
+    }
+#endif
+
+    ImplementacionEscaner detectar_implementacion() {
+#ifdef ESCANER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return ImplementacionEscaner::AVX2;
+        if (__builtin_cpu_supports("sse2")) return ImplementacionEscaner::SSE2;
+#endif
+        return ImplementacionEscaner::ESCALAR;
+    }
+
+    atomic<ImplementacionEscaner> implementacion_elegida{detectar_implementacion()};
+}
+
+ImplementacionEscaner implementacion_escaner() {
+    return implementacion_elegida.load(memory_order_relaxed);
+}
+
+void forzar_implementacion_escaner(ImplementacionEscaner implementacion) {
+    implementacion_elegida.store(implementacion, memory_order_relaxed);
+}
+
+const char* nombre_implementacion(ImplementacionEscaner implementacion) {
+    switch (implementacion) {
+        case ImplementacionEscaner::AVX2: return "avx2";
+        case ImplementacionEscaner::SSE2: return "sse2";
+        default: return "escalar";
+    }
+}
+
+void clasificar_bloques(const char* p, size_t bloques, MascarasBloque* mascaras) {
+    switch (implementacion_escaner()) {
+#ifdef ESCANER_X86
+        case ImplementacionEscaner::AVX2: clasificar_avx2(p, bloques, mascaras); return;
+        case ImplementacionEscaner::SSE2: clasificar_sse2(p, bloques, mascaras); return;
+#endif
+        default: clasificar_escalar(p, bloques, mascaras); return;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 🔎 Escáner de líneas
+// -----------------------------------------------------------------------------
+
+EscanerLineas::EscanerLineas(string_view texto_fuente)
+    : texto(texto_fuente), cursor(0), base(0), cubiertos(0), bloque_saltos(0), saltos_pendientes(0),
+      leidas(0), extraidas(0) {}
+
+void EscanerLineas::cargar(size_t desde) {
+    base = desde;
+    cubiertos = min(texto.size() - desde, BLOQUES_VENTANA * 64);
+    const size_t completos = cubiertos / 64;
+    clasificar_bloques(texto.data() + base, completos, mascaras);
+
+    // El último bloque incompleto se clasifica desde una copia rellena con
+    // ceros (que no son salto, comentario, espacio ni comilla)
+    const size_t resto = cubiertos % 64;
+    if (resto > 0) {
+        char relleno[64] = {};
+        memcpy(relleno, texto.data() + base + completos * 64, resto);
+        clasificar_bloques(relleno, 1, mascaras + completos);
+    }
+    mascaras[(cubiertos + 63) / 64] = MascarasBloque{0, 0, 0, 0};
+    bloque_saltos = 0;
+    saltos_pendientes = mascaras[0].saltos;
+}
+
+void EscanerLineas::limpiar_escalar(size_t inicio, size_t fin, LineaEscaneada& linea) const {
+    string_view resto = texto.substr(inicio, fin - inicio);
+    size_t pos = inicio_comentario(resto);
+    if (pos != string_view::npos) resto = resto.substr(0, pos);
+    linea.texto = recortar(resto);
+    linea.fin_token = 0;
+    while (linea.fin_token < linea.texto.size() && !es_espacio(linea.texto[linea.fin_token])) ++linea.fin_token;
+    linea.comienzo = inicio;
+}
+
+inline void EscanerLineas::limpiar(size_t inicio, size_t fin, LineaEscaneada& linea) const {
+    if (fin - inicio >= 64) {
+        limpiar_escalar(inicio, fin, linea);
+        return;
+    }
+
+    // La línea cabe en los 64 bytes que empiezan en 'inicio': se arma una
+    // ventana de máscaras alineada con ella (sin saltos: el bloque tras la
+    // ventana está a cero) y comentario, extremos y fin de la primera palabra
+    // salen de unos pocos ctz/clz
+    const MascarasBloque* m = mascaras + (inicio - base) / 64;
+    const unsigned desp = (inicio - base) % 64;
+    auto ventana = [desp](uint64_t actual, uint64_t siguiente) {
+        return (actual >> desp) | ((siguiente << 1) << (63 - desp));
+    };
+    const unsigned largo = static_cast<unsigned>(fin - inicio);
+    const uint64_t comentarios = ventana(m[0].comentarios, m[1].comentarios);
+    const unsigned corte = __builtin_ctzll(comentarios | (1ull << largo));
+    if (ventana(m[0].comillas, m[1].comillas) & ((1ull << corte) - 1)) {
+        // Una cadena antes del ';' puede contener otro ';': byte a byte
+        limpiar_escalar(inicio, fin, linea);
+        return;
+    }
+    const uint64_t espacios = ventana(m[0].espacios, m[1].espacios);
+    const uint64_t contenido = ~espacios & ((1ull << corte) - 1);
+
+    linea.comienzo = inicio;
+    if (contenido == 0) {
+        linea.texto = string_view(texto.data() + inicio, 0);
+        linea.fin_token = 0;
+        return;
+    }
+    const unsigned primero = __builtin_ctzll(contenido);
+    const unsigned tras_ultimo = 64 - __builtin_clzll(contenido);
+    const uint64_t separadores = espacios & (~0ull << primero);
+    linea.texto = string_view(texto.data() + inicio + primero, tras_ultimo - primero);
+    linea.fin_token = min<unsigned>(__builtin_ctzll(separadores | (1ull << 63)), tras_ultimo) - primero;
+}
+
+void EscanerLineas::extraer_lote() {
+    leidas = extraidas = 0;
+    while (extraidas < LINEAS_LOTE && cursor < texto.size()) {
+        if (cursor >= base + cubiertos) cargar(cursor);
+
+        // 1. Los fines de línea son los bits de las máscaras de saltos, que se
+        //    van consumiendo (m &= m - 1): el fin de una línea no espera a que
+        //    se termine de limpiar la anterior
+        size_t bloque = bloque_saltos, inicio = cursor, n = extraidas;
+        uint64_t saltos = saltos_pendientes;
+        while (n < LINEAS_LOTE) {
+            while (saltos == 0 && (bloque + 1) * 64 < cubiertos) saltos = mascaras[++bloque].saltos;
+            if (saltos == 0) break;
+            const size_t fin = base + bloque * 64 + __builtin_ctzll(saltos);
+            saltos &= saltos - 1;
+            limpiar(inicio, fin, lote[n++]);
+            inicio = fin + 1;
+        }
+        bloque_saltos = bloque;
+        saltos_pendientes = saltos;
+        cursor = inicio;
+        extraidas = n;
+        if (n == LINEAS_LOTE || cursor >= texto.size()) break;
+
+        // 2. No quedan saltos en la ventana
+        const size_t limite = base + cubiertos;
+        if (limite == texto.size()) {
+            // Última línea, sin '\n'
+            limpiar(cursor, limite, lote[extraidas++]);
+            cursor = limite;
+        } else if (cursor > base) {
+            // La línea sale de la ventana: se vuelve a clasificar desde su comienzo
+            cargar(cursor);
+        } else {
+            // Ni así cabe: se limpia byte a byte
+            const void* salto = memchr(texto.data() + limite, '\n', texto.size() - limite);
+            const size_t fin = salto ? static_cast<size_t>(static_cast<const char*>(salto) - texto.data()) : texto.size();
+            limpiar_escalar(cursor, fin, lote[extraidas++]);
+            cursor = fin + 1;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef ESCANER_LINEAS_HPP
+#define ESCANER_LINEAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+using namespace std;
+
+// --- CLASIFICACIÓN DE BLOQUES ---
+// Un bit por byte de un bloque de 64 bytes (bit i = byte i del bloque)
+struct MascarasBloque {
+    uint64_t saltos;        // '\n'
+    uint64_t comentarios;   // ';'
+    uint64_t espacios;      // es_espacio()
+    uint64_t comillas;      // '\'' y '"'
+};
+
+enum class ImplementacionEscaner : uint8_t { ESCALAR, SSE2, AVX2 };
+
+// Se elige al arrancar la mejor que admite la CPU (AVX2, SSE2 o escalar);
+// forzar_implementacion_escaner sirve para comparar (no se comprueba la CPU)
+ImplementacionEscaner implementacion_escaner();
+void forzar_implementacion_escaner(ImplementacionEscaner implementacion);
+const char* nombre_implementacion(ImplementacionEscaner implementacion);
+
+// Clasifica 'bloques' bloques completos de 64 bytes a partir de 'p'
+void clasificar_bloques(const char* p, size_t bloques, MascarasBloque* mascaras);
+
+// Una línea de la fuente ya limpia: sin comentario (desde el primer ';' fuera
+// de comillas) ni espacios en los extremos
+struct LineaEscaneada {
+    string_view texto;
+    size_t fin_token;   // Fin de la primera palabra (primer espacio o texto.size())
+    size_t comienzo;    // Posición de la línea original en la fuente
+};
+
+// --- ESCÁNER DE LÍNEAS ---
+// Sustituye a siguiente_linea + limpiar_linea. Clasifica la entrada por
+// ventanas de 256 bloques con SIMD y saca las líneas por lotes: fin de línea,
+// comentario, extremos sin espacios y fin de la primera palabra salen de
+// operaciones de bits sobre las máscaras, sin volver a recorrer los bytes.
+// Una línea de 64 bytes o más, o con comillas antes del primer ';', se
+// limpia byte a byte.
+class EscanerLineas {
+private:
+    static constexpr size_t BLOQUES_VENTANA = 256;
+    static constexpr size_t LINEAS_LOTE = 256;
+
+    string_view texto;
+    size_t cursor;              // Comienzo de la primera línea sin extraer
+    size_t base;                // Posición del primer byte clasificado
+    size_t cubiertos;           // Bytes clasificados a partir de 'base'
+    size_t bloque_saltos;       // Bloque de la ventana donde se buscan los saltos
+    uint64_t saltos_pendientes; // Sus saltos de línea aún no consumidos
+    size_t leidas, extraidas;   // Posición de lectura y tamaño del lote
+    MascarasBloque mascaras[BLOQUES_VENTANA + 1]; // El último, a cero, de guarda
+    LineaEscaneada lote[LINEAS_LOTE];
+
+    void cargar(size_t desde);
+    void extraer_lote();
+    void limpiar(size_t inicio, size_t fin, LineaEscaneada& linea) const;
+    void limpiar_escalar(size_t inicio, size_t fin, LineaEscaneada& linea) const;
+
+public:
+    explicit EscanerLineas(string_view texto_fuente);
+    EscanerLineas(const EscanerLineas&) = delete;
+    EscanerLineas& operator=(const EscanerLineas&) = delete;
+
+    // Siguiente línea; false al llegar al final
+    bool siguiente(LineaEscaneada& linea) {
+        if (leidas == extraidas) {
+            extraer_lote();
+            if (extraidas == 0) return false;
+        }
+        linea = lote[leidas++];
+        return true;
+    }
+};
+
+#endif // ESCANER_LINEAS_HPP
@@ -0,0 +1,110 @@
+#include "Estadisticas.hpp"
+
+namespace asignaciones {
+    atomic<bool> activo(false);
+    atomic<uint64_t> total(0);
+    atomic<uint64_t> bytes(0);
+}
+
+namespace {
+    const char* const NOMBRES_CLASES[EstadisticasEnsamblado::CLASES] = {
+        "directiva", "transferencia", "aritmetica", "control", "vectorial", "miscelanea"
+    };
+
+    double a_segundos(uint64_t ns) {
+        return static_cast<double>(ns) / 1e9;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 📌 Estado
+// -----------------------------------------------------------------------------
+
+void EstadisticasEnsamblado::activar(bool valor) {
+    limpiar();
+    activas = valor;
+}
+
+void EstadisticasEnsamblado::limpiar() {
+    bool estaban_activas = activas;
+    *this = EstadisticasEnsamblado();
+    activas = estaban_activas;
+    base_asignaciones = asignaciones::total.load(memory_order_relaxed);
+    base_bytes_asignados = asignaciones::bytes.load(memory_order_relaxed);
+}
+
+void EstadisticasEnsamblado::acumular(const EstadisticasEnsamblado& otra) {
+    // Los tiempos se suman: es tiempo de CPU entre todos los hilos. Las
+    // asignaciones no, porque ya son contadores de todo el proceso
+    ns_lectura += otra.ns_lectura;
+    ns_lexico += otra.ns_lexico;
+    for (size_t c = 0; c < CLASES; ++c) {
+        ns_codificacion[c] += otra.ns_codificacion[c];
+        instrucciones_por_clase[c] += otra.instrucciones_por_clase[c];
+    }
+    ns_enlace += otra.ns_enlace;
+    ns_relajacion += otra.ns_relajacion;
+    ns_resolucion += otra.ns_resolucion;
+    ns_salida += otra.ns_salida;
+
+    lineas += otra.lineas;
+    instrucciones += otra.instrucciones;
+    etiquetas += otra.etiquetas;
+    referencias_pendientes += otra.referencias_pendientes;
+    saltos_relajables += otra.saltos_relajables;
+    saltos_largos += otra.saltos_largos;
+    relleno_alineacion += otra.relleno_alineacion;
+    simbolos_sin_resolver += otra.simbolos_sin_resolver;
+    bytes_codigo += otra.bytes_codigo;
+}
+
+void EstadisticasEnsamblado::actualizar_asignaciones() {
+    asignaciones = asignaciones::total.load(memory_order_relaxed) - base_asignaciones;
+    bytes_asignados = asignaciones::bytes.load(memory_order_relaxed) - base_bytes_asignados;
+}
+
+// -----------------------------------------------------------------------------
+// 📤 Informe JSON
+// -----------------------------------------------------------------------------
+
+void EstadisticasEnsamblado::escribir_json(ostream& os) const {
+    uint64_t ns_codificacion_total = 0;
+    for (size_t c = 0; c < CLASES; ++c) ns_codificacion_total += ns_codificacion[c];
+
+    os << "{\n";
+    os << "  \"tiempos_s\": {\n";
+    os << "    \"lectura\": " << a_segundos(ns_lectura) << ",\n";
+    os << "    \"lexico\": " << a_segundos(ns_lexico) << ",\n";
+    os << "    \"codificacion\": " << a_segundos(ns_codificacion_total) << ",\n";
+    os << "    \"codificacion_por_clase\": {";
+    for (size_t c = 0; c < CLASES; ++c) {
+        os << (c ? ", " : "") << "\"" << NOMBRES_CLASES[c] << "\": " << a_segundos(ns_codificacion[c]);
+    }
+    os << "},\n";
+    os << "    \"enlace\": " << a_segundos(ns_enlace) << ",\n";
+    os << "    \"relajacion\": " << a_segundos(ns_relajacion) << ",\n";
+    os << "    \"resolucion\": " << a_segundos(ns_resolucion) << ",\n";
+    os << "    \"salida\": " << a_segundos(ns_salida) << "\n";
+    os << "  },\n";
+    os << "  \"contadores\": {\n";
+    os << "    \"lineas\": " << lineas << ",\n";
+    os << "    \"instrucciones\": " << instrucciones << ",\n";
+    os << "    \"instrucciones_por_clase\": {";
+    for (size_t c = 0; c < CLASES; ++c) {
+        os << (c ? ", " : "") << "\"" << NOMBRES_CLASES[c] << "\": " << instrucciones_por_clase[c];
+    }
+    os << "},\n";
+    os << "    \"etiquetas\": " << etiquetas << ",\n";
+    os << "    \"referencias_pendientes\": " << referencias_pendientes << ",\n";
+    os << "    \"saltos_relajables\": " << saltos_relajables << ",\n";
+    os << "    \"saltos_largos\": " << saltos_largos << ",\n";
+    os << "    \"relleno_alineacion\": " << relleno_alineacion << ",\n";
+    os << "    \"simbolos_sin_resolver\": " << simbolos_sin_resolver << ",\n";
+    os << "    \"bytes_codigo\": " << bytes_codigo << "\n";
+    os << "  },\n";
+    os << "  \"memoria\": {\n";
+    os << "    \"asignaciones\": " << asignaciones << ",\n";
+    os << "    \"bytes_asignados\": " << bytes_asignados << "\n";
+    os << "  }\n";
+    os << "}\n";
+}
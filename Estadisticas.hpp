@@ -0,0 +1,87 @@
+#ifndef ESTADISTICAS_HPP
+#define ESTADISTICAS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "TablaOpcodes.hpp"
+
+using namespace std;
+
+// --- CONTADORES DE ASIGNACIONES ---
+// La biblioteca no reemplaza operator new: el programa que quiera contar
+// asignaciones lo reemplaza y suma aquí cuando 'activo' está encendido
+// (ContadorAsignaciones.cpp, enlazado en el ejecutable, lo hace). Son
+// contadores de todo el proceso.
+namespace asignaciones {
+    extern atomic<bool> activo;
+    extern atomic<uint64_t> total;
+    extern atomic<uint64_t> bytes;
+}
+
+inline uint64_t reloj_ns() {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Suma a 'destino' el tiempo de vida del objeto; con destino nulo no mide nada
+class CronometroEtapa {
+private:
+    uint64_t* destino;
+    uint64_t inicio;
+
+public:
+    explicit CronometroEtapa(uint64_t* destino_ns)
+        : destino(destino_ns), inicio(destino_ns ? reloj_ns() : 0) {}
+    ~CronometroEtapa() {
+        if (destino) *destino += reloj_ns() - inicio;
+    }
+    CronometroEtapa(const CronometroEtapa&) = delete;
+    CronometroEtapa& operator=(const CronometroEtapa&) = delete;
+};
+
+// --- ESTADÍSTICAS DE UNA EJECUCIÓN ---
+// Sólo se rellenan si 'activas' es true; desactivadas cuestan una
+// comprobación de booleano por línea.
+struct EstadisticasEnsamblado {
+    static constexpr size_t CLASES = static_cast<size_t>(ClaseMnemonico::TOTAL);
+
+    bool activas = false;
+
+    // Tiempos (nanosegundos)
+    uint64_t ns_lectura = 0;                    // Apertura y proyección del archivo
+    uint64_t ns_lexico = 0;                     // Líneas, etiquetas y operandos
+    uint64_t ns_codificacion[CLASES] = {};      // Selección de forma y emisión
+    uint64_t ns_enlace = 0;                     // Unión de fragmentos (paralelo)
+    uint64_t ns_relajacion = 0;                 // Tamaño final de los saltos
+    uint64_t ns_resolucion = 0;                 // Parcheo de referencias
+    uint64_t ns_salida = 0;                     // Archivos de salida y reportes
+
+    // Contadores
+    uint64_t lineas = 0;
+    uint64_t instrucciones = 0;
+    uint64_t instrucciones_por_clase[CLASES] = {};
+    uint64_t etiquetas = 0;
+    uint64_t referencias_pendientes = 0;
+    uint64_t saltos_relajables = 0;
+    uint64_t saltos_largos = 0;
+    uint64_t relleno_alineacion = 0;            // Bytes de NOP de ALIGN y de bucles
+    uint64_t simbolos_sin_resolver = 0;
+    uint64_t bytes_codigo = 0;
+
+    // Asignaciones desde que se activaron (si el programa las cuenta)
+    uint64_t asignaciones = 0;
+    uint64_t bytes_asignados = 0;
+    uint64_t base_asignaciones = 0;
+    uint64_t base_bytes_asignados = 0;
+
+    void activar(bool valor);
+    void limpiar();                                     // Pone a cero, conserva 'activas'
+    void acumular(const EstadisticasEnsamblado& otra);  // Suma la de un fragmento o archivo
+    void actualizar_asignaciones();
+    void escribir_json(ostream& os) const;
+};
+
+#endif // ESTADISTICAS_HPP
@@ -0,0 +1,101 @@
+#include "InternadorSimbolos.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// -----------------------------------------------------------------------------
+// 📌 Inicialización
+// -----------------------------------------------------------------------------
+
+InternadorSimbolos::InternadorSimbolos() : bloque_actual(0), usado_bloque(TAM_BLOQUE) {
+    ranuras.assign(1024, 0);
+}
+
+void InternadorSimbolos::limpiar() {
+    // Los bloques de la arena y la capacidad de las tablas se reutilizan
+    bloque_actual = 0;
+    usado_bloque = bloques.empty() ? TAM_BLOQUE : 0;
+    nombres_grandes.clear();
+    nombres.clear();
+    hashes.clear();
+    fill(ranuras.begin(), ranuras.end(), 0);
+}
+
+// -----------------------------------------------------------------------------
+// 🧹 Utilidades
+// -----------------------------------------------------------------------------
+
+uint32_t InternadorSimbolos::calcular_hash(string_view s) {
+    // FNV-1a de 32 bits
+    uint32_t h = 2166136261u;
+    for (char c : s) h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+    return h;
+}
+
+const char* InternadorSimbolos::copiar_a_arena(string_view s) {
+    if (s.size() > TAM_BLOQUE) {
+        // Nombre gigante: bloque propio fuera de la arena
+        nombres_grandes.emplace_back(new char[s.size()]);
+        memcpy(nombres_grandes.back().get(), s.data(), s.size());
+        return nombres_grandes.back().get();
+    }
+
+    if (usado_bloque + s.size() > TAM_BLOQUE) {
+        if (bloque_actual + 1 < bloques.size()) {
+            ++bloque_actual; // Bloque conservado tras limpiar()
+        } else {
+            bloques.emplace_back(new char[TAM_BLOQUE]);
+            bloque_actual = bloques.size() - 1;
+        }
+        usado_bloque = 0;
+    }
+
+    char* destino = bloques[bloque_actual].get() + usado_bloque;
+    memcpy(destino, s.data(), s.size());
+    usado_bloque += s.size();
+    return destino;
+}
+
+void InternadorSimbolos::crecer_tabla() {
+    vector<uint32_t> nuevas(ranuras.size() * 2, 0);
+    const size_t mascara = nuevas.size() - 1;
+    for (uint32_t id = 0; id < nombres.size(); ++id) {
+        size_t i = hashes[id] & mascara;
+        while (nuevas[i] != 0) i = (i + 1) & mascara;
+        nuevas[i] = id + 1;
+    }
+    ranuras.swap(nuevas);
+}
+
+// -----------------------------------------------------------------------------
+// 🔎 Búsqueda e inserción
+// -----------------------------------------------------------------------------
+
+uint32_t InternadorSimbolos::buscar(string_view nombre) const {
+    const uint32_t h = calcular_hash(nombre);
+    const size_t mascara = ranuras.size() - 1;
+    for (size_t i = h & mascara; ranuras[i] != 0; i = (i + 1) & mascara) {
+        uint32_t id = ranuras[i] - 1;
+        if (hashes[id] == h && nombres[id] == nombre) return id;
+    }
+    return NINGUNO;
+}
+
+uint32_t InternadorSimbolos::internar(string_view nombre) {
+    const uint32_t h = calcular_hash(nombre);
+    size_t mascara = ranuras.size() - 1;
+    size_t i = h & mascara;
+    for (; ranuras[i] != 0; i = (i + 1) & mascara) {
+        uint32_t id = ranuras[i] - 1;
+        if (hashes[id] == h && nombres[id] == nombre) return id;
+    }
+
+    uint32_t id = static_cast<uint32_t>(nombres.size());
+    nombres.emplace_back(copiar_a_arena(nombre), nombre.size());
+    hashes.push_back(h);
+    ranuras[i] = id + 1;
+
+    // Factor de carga máximo del 50%
+    if (nombres.size() * 2 > ranuras.size()) crecer_tabla();
+    return id;
+}
@@ -0,0 +1,53 @@
+#ifndef INTERNADOR_SIMBOLOS_HPP
+#define INTERNADOR_SIMBOLOS_HPP
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// --- INTERNADOR DE SÍMBOLOS ---
+// Asigna a cada nombre de etiqueta un identificador entero denso (0, 1, 2, ...).
+// Los nombres se copian una sola vez a una arena de bloques que nunca se mueven,
+// de modo que las vistas devueltas por nombre() son estables mientras viva el
+// internador (o hasta limpiar()).
+class InternadorSimbolos {
+public:
+    static constexpr uint32_t NINGUNO = 0xFFFFFFFFu;
+
+private:
+    static constexpr size_t TAM_BLOQUE = 64 * 1024;
+
+    vector<unique_ptr<char[]>> bloques; // Arena de nombres
+    size_t bloque_actual;               // Bloque donde se copian los nombres nuevos
+    size_t usado_bloque;                // Bytes ocupados del bloque actual
+    vector<unique_ptr<char[]>> nombres_grandes; // Nombres mayores que un bloque
+
+    vector<string_view> nombres;        // ID -> nombre (apunta a la arena)
+    vector<uint32_t> hashes;            // ID -> hash del nombre
+    vector<uint32_t> ranuras;           // Tabla abierta: ID+1 (0 = vacía), tamaño potencia de 2
+
+    static uint32_t calcular_hash(string_view s);
+    const char* copiar_a_arena(string_view s);
+    void crecer_tabla();
+
+public:
+    InternadorSimbolos();
+
+    // Devuelve el ID del nombre, creándolo si no existía
+    uint32_t internar(string_view nombre);
+
+    // Devuelve el ID del nombre o NINGUNO si no se ha internado
+    uint32_t buscar(string_view nombre) const;
+
+    string_view nombre(uint32_t id) const { return nombres[id]; }
+    size_t total() const { return nombres.size(); }
+
+    // Olvida todos los nombres pero conserva la memoria reservada
+    void limpiar();
+};
+
+#endif // INTERNADOR_SIMBOLOS_HPP
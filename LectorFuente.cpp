@@ -0,0 +1,61 @@
+#include "LectorFuente.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// 📂 Apertura y cierre
+// -----------------------------------------------------------------------------
+
+LectorFuente::LectorFuente() : datos(nullptr), tamano(0), mapeo(nullptr) {}
+
+LectorFuente::~LectorFuente() {
+    cerrar();
+}
+
+bool LectorFuente::abrir(const string& ruta) {
+    cerrar();
+
+    int fd = ::open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // Lectura estrictamente secuencial: pedir lectura anticipada agresiva
+            madvise(p, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            mapeo = p;
+            datos = static_cast<const char*>(p);
+            tamano = static_cast<size_t>(info.st_size);
+            ::close(fd);
+            return true;
+        }
+    }
+
+    // Respaldo: leer todo el archivo a memoria
+    char bloque[1 << 16];
+    ssize_t leidos;
+    while ((leidos = ::read(fd, bloque, sizeof(bloque))) > 0) {
+        respaldo.insert(respaldo.end(), bloque, bloque + leidos);
+    }
+    ::close(fd);
+    if (leidos < 0) {
+        respaldo.clear();
+        return false;
+    }
+
+    datos = respaldo.data();
+    tamano = respaldo.size();
+    return true;
+}
+
+void LectorFuente::cerrar() {
+    if (mapeo) munmap(mapeo, tamano);
+    mapeo = nullptr;
+    respaldo.clear();
+    datos = nullptr;
+    tamano = 0;
+}
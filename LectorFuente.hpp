@@ -0,0 +1,111 @@
+#ifndef LECTOR_FUENTE_HPP
+#define LECTOR_FUENTE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+
+using namespace std;
+
+// --- UTILIDADES DE ANÁLISIS LÉXICO ---
+// Todas trabajan sobre string_view del búfer de entrada, sin copiar ni
+// convertir a mayúsculas.
+
+inline bool es_espacio(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+inline char a_mayuscula(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Compara sin distinguir mayúsculas (ASCII)
+inline bool igual_sin_mayusculas(string_view a, string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a_mayuscula(a[i]) != a_mayuscula(b[i])) return false;
+    }
+    return true;
+}
+
+// Hash e igualdad sin distinguir mayúsculas, para tablas indexadas por string_view
+struct HashSinMayusculas {
+    size_t operator()(string_view s) const {
+        size_t h = 2166136261u;
+        for (char c : s) h = (h ^ static_cast<uint8_t>(a_mayuscula(c))) * 16777619u;
+        return h;
+    }
+};
+
+struct IgualSinMayusculas {
+    bool operator()(string_view a, string_view b) const { return igual_sin_mayusculas(a, b); }
+};
+
+// Elimina espacios en blanco al inicio y al final
+inline string_view recortar(string_view s) {
+    size_t ini = 0, fin = s.size();
+    while (ini < fin && es_espacio(s[ini])) ++ini;
+    while (fin > ini && es_espacio(s[fin - 1])) --fin;
+    return s.substr(ini, fin - ini);
+}
+
+// Posición del ';' que abre el comentario (npos si no hay); los ';' entre
+// comillas simples o dobles son parte de una cadena
+inline size_t inicio_comentario(string_view s) {
+    char comilla = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const char c = s[i];
+        if (comilla) {
+            if (c == comilla) comilla = 0;
+        } else if (c == '\'' || c == '"') {
+            comilla = c;
+        } else if (c == ';') {
+            return i;
+        }
+    }
+    return string_view::npos;
+}
+
+// Extrae de 'texto' la línea que empieza en 'cursor' (sin el '\n' final) y
+// avanza el cursor a la siguiente; false al llegar al final
+inline bool siguiente_linea(string_view texto, size_t& cursor, string_view& linea) {
+    if (cursor >= texto.size()) return false;
+
+    const char* inicio = texto.data() + cursor;
+    const void* salto = memchr(inicio, '\n', texto.size() - cursor);
+    size_t largo = salto ? static_cast<size_t>(static_cast<const char*>(salto) - inicio)
+                         : texto.size() - cursor;
+
+    linea = string_view(inicio, largo);
+    cursor += largo + 1;
+    return true;
+}
+
+// --- LECTOR DE ARCHIVOS FUENTE ---
+// Proyecta el archivo en memoria (mmap) y entrega sus líneas como vistas sobre
+// el propio mapeo. Si el archivo no se puede proyectar (tubería, dispositivo...)
+// se lee completo a un búfer interno.
+class LectorFuente {
+private:
+    const char* datos;
+    size_t tamano;
+
+    void* mapeo;           // Región de mmap (nullptr si se usa el respaldo)
+    vector<char> respaldo; // Contenido leído cuando no hay mmap
+
+public:
+    LectorFuente();
+    ~LectorFuente();
+    LectorFuente(const LectorFuente&) = delete;
+    LectorFuente& operator=(const LectorFuente&) = delete;
+
+    bool abrir(const string& ruta);
+    void cerrar();
+
+    string_view contenido() const { return string_view(datos, tamano); }
+};
+
+#endif // LECTOR_FUENTE_HPP
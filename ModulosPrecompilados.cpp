@@ -0,0 +1,292 @@
+#include "ModulosPrecompilados.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIA[4] = {'E', 'I', 'M', 'P'};
+    constexpr uint32_t VERSION_FORMATO = 3;
+}
+
+// -----------------------------------------------------------------------------
+// 📌 Hash y clave
+// -----------------------------------------------------------------------------
+
+uint64_t hash_contenido(string_view texto) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : texto) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    return h;
+}
+
+uint64_t clave_modulo(uint64_t hash, bool optimizar, SeccionELF seccion) {
+    uint64_t h = (hash ^ VERSION_FORMATO) * 1099511628211ull;
+    for (const char* c = VERSION_ENSAMBLADOR; *c; ++c) h = (h ^ static_cast<uint8_t>(*c)) * 1099511628211ull;
+    if (seccion != SeccionELF::TEXTO) h = (h ^ (0x53 + static_cast<uint8_t>(seccion))) * 1099511628211ull;
+    return optimizar ? (h ^ 0x4F) * 1099511628211ull : h;
+}
+
+// -----------------------------------------------------------------------------
+// 💾 Serialización
+// -----------------------------------------------------------------------------
+
+namespace {
+    void escribir_referencias(EscritorBinario& e, const vector<ReferenciaPendiente>& referencias) {
+        e.u32(static_cast<uint32_t>(referencias.size()));
+        for (const ReferenciaPendiente& r : referencias) {
+            e.u32(r.posicion);
+            e.u32(r.simbolo);
+            e.u32(static_cast<uint32_t>(r.sumando));
+            e.u8(r.tamano_inmediato);
+            e.u8(r.tipo_salto);
+        }
+    }
+
+    bool leer_referencias(LectorBinario& l, vector<ReferenciaPendiente>& referencias, size_t simbolos, size_t tamano) {
+        referencias.resize(l.cuenta(14));
+        for (ReferenciaPendiente& r : referencias) {
+            r.posicion = l.u32();
+            r.simbolo = l.u32();
+            r.sumando = static_cast<int32_t>(l.u32());
+            r.tamano_inmediato = l.u8();
+            r.tipo_salto = l.u8();
+            if (r.simbolo >= simbolos || r.posicion + r.tamano_inmediato > tamano) return false;
+        }
+        return true;
+    }
+
+    // ALIGN de .data y .bss: sólo posición, alineación y relleno máximo
+    void escribir_alineaciones(EscritorBinario& e, const vector<SaltoRelajable>& puntos) {
+        e.u32(static_cast<uint32_t>(puntos.size()));
+        for (const SaltoRelajable& p : puntos) {
+            e.u32(static_cast<uint32_t>(p.posicion));
+            e.u32(p.alineacion | static_cast<uint32_t>(p.relleno_maximo) << 16);
+        }
+    }
+
+    bool leer_alineaciones(LectorBinario& l, vector<SaltoRelajable>& puntos, int tamano) {
+        puntos.resize(l.cuenta(8));
+        for (SaltoRelajable& p : puntos) {
+            p = SaltoRelajable();
+            p.posicion = static_cast<int>(l.u32());
+            const uint32_t alineacion = l.u32();
+            p.alineacion = static_cast<uint16_t>(alineacion);
+            p.relleno_maximo = static_cast<uint16_t>(alineacion >> 16);
+            p.destino = -1;
+            if (p.alineacion == 0 || p.posicion < 0 || p.posicion > tamano) return false;
+        }
+        return true;
+    }
+}
+
+void serializar_modulo(const ModuloPrecompilado& modulo, string& salida) {
+    const FragmentoCodificado& f = modulo.fragmento;
+    salida.clear();
+    salida.reserve(96 + f.codigo.size() + f.nombres.size() + f.fin_nombres.size() * 10 +
+                   f.referencias.size() * 14 + f.saltos.size() * 18 + f.datos.codigo.size() +
+                   f.datos.referencias.size() * 14 + f.diagnosticos.size());
+    EscritorBinario e{salida};
+
+    e.bytes(MAGIA, sizeof(MAGIA));
+    e.u32(VERSION_FORMATO);
+    e.u64(modulo.hash);
+
+    e.u32(static_cast<uint32_t>(modulo.dependencias.size()));
+    for (const DependenciaModulo& d : modulo.dependencias) {
+        e.u64(d.hash);
+        e.texto(d.ruta);
+    }
+
+    e.texto(string_view(reinterpret_cast<const char*>(f.codigo.data()), f.codigo.size()));
+    e.texto(f.nombres);
+    e.u32(static_cast<uint32_t>(f.fin_nombres.size()));
+    for (size_t id = 0; id < f.fin_nombres.size(); ++id) {
+        e.u32(f.fin_nombres[id]);
+        e.u32(static_cast<uint32_t>(f.posiciones[id]));
+        e.u8(f.globales[id]);
+        e.u8(static_cast<uint8_t>(f.secciones_simbolos[id]));
+    }
+    escribir_referencias(e, f.referencias);
+
+    // Los saltos se guardan sin relajar: destino, largo y eliminado se
+    // calculan al enlazar el programa (y el relleno de los ALIGN)
+    e.u32(static_cast<uint32_t>(f.saltos.size()));
+    for (const SaltoRelajable& s : f.saltos) {
+        e.u32(static_cast<uint32_t>(s.posicion));
+        e.u8(s.condicional);
+        e.u8(s.condicion);
+        e.u32(s.simbolo);
+        e.u32(static_cast<uint32_t>(s.sumando));
+        e.u32(s.alineacion | static_cast<uint32_t>(s.relleno_maximo) << 16);
+    }
+
+    // .data (con sus DD etiqueta) y .bss, que sólo tiene tamaño
+    e.texto(string_view(reinterpret_cast<const char*>(f.datos.codigo.data()), f.datos.codigo.size()));
+    escribir_referencias(e, f.datos.referencias);
+    escribir_alineaciones(e, f.datos.saltos);
+    e.u32(static_cast<uint32_t>(f.bss.posicion));
+    escribir_alineaciones(e, f.bss.saltos);
+    e.u8(static_cast<uint8_t>(f.seccion_final));
+
+    const InformeOptimizacion& o = f.optimizaciones;
+    e.u64(o.mov_cero_a_xor);
+    e.u64(o.suma_uno_a_inc);
+    e.u64(o.movs_redundantes);
+    e.u64(o.saltos_al_siguiente);
+    e.texto(f.diagnosticos);
+}
+
+bool deserializar_modulo(string_view datos, ModuloPrecompilado& modulo) {
+    LectorBinario l{datos};
+    if (!l.hay(sizeof(MAGIA)) || memcmp(datos.data(), MAGIA, sizeof(MAGIA)) != 0) return false;
+    l.p += sizeof(MAGIA);
+    if (l.u32() != VERSION_FORMATO) return false;
+    modulo.hash = l.u64();
+
+    uint32_t total = l.cuenta(12);
+    modulo.dependencias.resize(total);
+    for (DependenciaModulo& d : modulo.dependencias) {
+        d.hash = l.u64();
+        d.ruta = l.texto();
+    }
+
+    FragmentoCodificado& f = modulo.fragmento;
+    string_view codigo = l.texto();
+    f.codigo.assign(codigo.begin(), codigo.end());
+    f.nombres = l.texto();
+
+    total = l.cuenta(10);
+    f.fin_nombres.resize(total);
+    f.posiciones.resize(total);
+    f.globales.assign(total, false);
+    f.secciones_simbolos.resize(total);
+    for (uint32_t id = 0; id < total; ++id) {
+        f.fin_nombres[id] = l.u32();
+        f.posiciones[id] = static_cast<int32_t>(l.u32());
+        f.globales[id] = l.u8() != 0;
+        const uint8_t seccion = l.u8();
+        f.secciones_simbolos[id] = static_cast<SeccionELF>(seccion);
+        if (f.fin_nombres[id] > f.nombres.size() || (id > 0 && f.fin_nombres[id] < f.fin_nombres[id - 1]) ||
+            seccion < static_cast<uint8_t>(SeccionELF::TEXTO) || seccion > static_cast<uint8_t>(SeccionELF::BSS)) {
+            return false;
+        }
+    }
+    if (!leer_referencias(l, f.referencias, f.fin_nombres.size(), f.codigo.size())) return false;
+
+    total = l.cuenta(18);
+    f.saltos.resize(total);
+    for (SaltoRelajable& s : f.saltos) {
+        s.posicion = static_cast<int>(l.u32());
+        s.condicional = l.u8() != 0;
+        s.condicion = l.u8();
+        s.largo = false;
+        s.eliminado = false;
+        s.destino = -1;
+        s.simbolo = l.u32();
+        s.sumando = static_cast<int32_t>(l.u32());
+        const uint32_t alineacion = l.u32();
+        s.alineacion = static_cast<uint16_t>(alineacion);
+        s.relleno_maximo = static_cast<uint16_t>(alineacion >> 16);
+        s.relleno = 0;
+        // Un ALIGN no ocupa bytes ni tiene símbolo
+        const size_t largo = s.alineacion ? 0 : 2;
+        if ((!s.alineacion && s.simbolo >= f.fin_nombres.size()) || s.posicion < 0 ||
+            static_cast<size_t>(s.posicion) + largo > f.codigo.size()) {
+            return false;
+        }
+    }
+
+    string_view datos_seccion = l.texto();
+    f.datos.codigo.assign(datos_seccion.begin(), datos_seccion.end());
+    f.datos.posicion = static_cast<int>(f.datos.codigo.size());
+    if (!leer_referencias(l, f.datos.referencias, f.fin_nombres.size(), f.datos.codigo.size()) ||
+        !leer_alineaciones(l, f.datos.saltos, f.datos.posicion)) {
+        return false;
+    }
+    f.bss.codigo.clear();
+    f.bss.referencias.clear();
+    f.bss.posicion = static_cast<int>(l.u32());
+    if (f.bss.posicion < 0 || !leer_alineaciones(l, f.bss.saltos, f.bss.posicion)) return false;
+    const uint8_t seccion_final = l.u8();
+    if (seccion_final < static_cast<uint8_t>(SeccionELF::TEXTO) || seccion_final > static_cast<uint8_t>(SeccionELF::BSS)) {
+        return false;
+    }
+    f.seccion_final = static_cast<SeccionELF>(seccion_final);
+
+    InformeOptimizacion& o = f.optimizaciones;
+    o.mov_cero_a_xor = l.u64();
+    o.suma_uno_a_inc = l.u64();
+    o.movs_redundantes = l.u64();
+    o.saltos_al_siguiente = l.u64();
+    f.diagnosticos = l.texto();
+    return l.ok;
+}
+
+// -----------------------------------------------------------------------------
+// 🗃️ Caché
+// -----------------------------------------------------------------------------
+
+CacheModulos::CacheModulos(const string& directorio_modulos) : directorio(directorio_modulos) {
+    if (!directorio.empty()) mkdir(directorio.c_str(), 0755);
+}
+
+string CacheModulos::ruta_modulo(uint64_t clave) const {
+    char nombre[32];
+    snprintf(nombre, sizeof(nombre), "%016llx.eim", static_cast<unsigned long long>(clave));
+    return directorio + "/" + nombre;
+}
+
+bool CacheModulos::dependencias_vigentes(const ModuloPrecompilado& modulo) {
+    for (const DependenciaModulo& d : modulo.dependencias) {
+        LectorFuente lector;
+        if (!lector.abrir(d.ruta) || hash_contenido(lector.contenido()) != d.hash) return false;
+    }
+    return true;
+}
+
+shared_ptr<const ModuloPrecompilado> CacheModulos::buscar(uint64_t clave) {
+    {
+        lock_guard<mutex> bloqueo(cerrojo);
+        auto it = memoria.find(clave);
+        if (it != memoria.end()) {
+            if (dependencias_vigentes(*it->second)) {
+                ++aciertos_memoria;
+                return it->second;
+            }
+            memoria.erase(it);
+        }
+    }
+    if (directorio.empty()) return nullptr;
+
+    // El módulo se lee directamente de la proyección del archivo
+    LectorFuente archivo;
+    if (!archivo.abrir(ruta_modulo(clave))) return nullptr;
+    auto modulo = make_shared<ModuloPrecompilado>();
+    if (!deserializar_modulo(archivo.contenido(), *modulo) || !dependencias_vigentes(*modulo)) return nullptr;
+
+    ++aciertos_disco;
+    lock_guard<mutex> bloqueo(cerrojo);
+    return memoria.emplace(clave, move(modulo)).first->second;
+}
+
+void CacheModulos::guardar(uint64_t clave, const shared_ptr<const ModuloPrecompilado>& modulo) {
+    {
+        lock_guard<mutex> bloqueo(cerrojo);
+        memoria[clave] = modulo;
+    }
+    if (directorio.empty()) return;
+
+    // Se escribe en un temporal y se renombra: otro proceso que lea el módulo
+    // a la vez ve el anterior o el nuevo completo, nunca uno a medias
+    string datos;
+    serializar_modulo(*modulo, datos);
+    const string ruta = ruta_modulo(clave);
+    const string temporal = ruta + "." + to_string(getpid()) + "." +
+                            to_string(hash<thread::id>()(this_thread::get_id())) + ".tmp";
+    if (volcar_archivo(temporal, datos.data(), datos.size())) {
+        if (rename(temporal.c_str(), ruta.c_str()) != 0) unlink(temporal.c_str());
+    }
+}
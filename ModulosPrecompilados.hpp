@@ -0,0 +1,64 @@
+#ifndef MODULOS_PRECOMPILADOS_HPP
+#define MODULOS_PRECOMPILADOS_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+using namespace std;
+
+// --- MÓDULO PRECOMPILADO ---
+// Resultado de ensamblar un archivo incluido con %include desde la posición 0:
+// código (y .data/.bss), símbolos, referencias sin resolver y saltos sin relajar. Se enlaza
+// como cualquier fragmento (enlazar_codificado), sin volver a leer el texto.
+struct ModuloPrecompilado {
+    uint64_t hash = 0;                      // Hash del texto fuente
+    FragmentoCodificado fragmento;
+    vector<DependenciaModulo> dependencias; // %include anidados (todos los niveles)
+};
+
+// FNV-1a de 64 bits del contenido
+uint64_t hash_contenido(string_view texto);
+
+// Clave de la caché: el contenido, las opciones que cambian la codificación y
+// la sección activa al incluirlo
+uint64_t clave_modulo(uint64_t hash, bool optimizar, SeccionELF seccion = SeccionELF::TEXTO);
+
+// Formato binario (little endian, versionado). deserializar_modulo devuelve
+// false si los datos están truncados o son de otra versión.
+void serializar_modulo(const ModuloPrecompilado& modulo, string& salida);
+bool deserializar_modulo(string_view datos, ModuloPrecompilado& modulo);
+
+// --- CACHÉ DE MÓDULOS ---
+// Compartida entre ensambladores (hilos del modo por lotes, fragmentos en
+// paralelo, inclusiones anidadas). Primero se busca en memoria y después, si
+// hay directorio, en <directorio>/<clave>.eim, proyectado con mmap. Un
+// módulo sólo vale si sus dependencias no han cambiado.
+class CacheModulos {
+private:
+    mutex cerrojo;
+    unordered_map<uint64_t, shared_ptr<const ModuloPrecompilado>> memoria;
+    string directorio;
+
+    string ruta_modulo(uint64_t clave) const;
+    static bool dependencias_vigentes(const ModuloPrecompilado& modulo);
+
+public:
+    atomic<uint64_t> aciertos_memoria{0};
+    atomic<uint64_t> aciertos_disco{0};
+    atomic<uint64_t> ensamblados{0};
+
+    // Con directorio vacío la caché vive sólo en memoria
+    explicit CacheModulos(const string& directorio_modulos = "");
+
+    shared_ptr<const ModuloPrecompilado> buscar(uint64_t clave);
+    void guardar(uint64_t clave, const shared_ptr<const ModuloPrecompilado>& modulo);
+};
+
+#endif // MODULOS_PRECOMPILADOS_HPP
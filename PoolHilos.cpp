@@ -0,0 +1,118 @@
+#include "PoolHilos.hpp"
+
+namespace {
+    // Pool e índice del hilo en ejecución (-1 para hilos ajenos)
+    thread_local const PoolHilos* pool_actual = nullptr;
+    thread_local int indice_hilo_actual = -1;
+}
+
+// -----------------------------------------------------------------------------
+// 📌 Creación y destrucción
+// -----------------------------------------------------------------------------
+
+PoolHilos::PoolHilos(unsigned total)
+    : en_cola(0), pendientes(0), detener(false), siguiente_cola(0) {
+    if (total == 0) total = thread::hardware_concurrency();
+    if (total == 0) total = 1;
+
+    for (unsigned i = 0; i < total; ++i) colas.emplace_back(new Cola());
+    for (unsigned i = 0; i < total; ++i) hilos.emplace_back(&PoolHilos::bucle, this, i);
+}
+
+PoolHilos::~PoolHilos() {
+    {
+        lock_guard<mutex> lock(m_estado);
+        detener = true;
+    }
+    cv_trabajo.notify_all();
+    for (auto& h : hilos) h.join();
+}
+
+int PoolHilos::hilo_actual() {
+    return indice_hilo_actual;
+}
+
+// -----------------------------------------------------------------------------
+// 📬 Envío y espera
+// -----------------------------------------------------------------------------
+
+void PoolHilos::enviar(function<void()> tarea) {
+    // Desde un hilo del pool, a su propia cola; desde fuera, reparto circular
+    unsigned destino = pool_actual == this
+                           ? static_cast<unsigned>(indice_hilo_actual)
+                           : siguiente_cola.fetch_add(1, memory_order_relaxed) % colas.size();
+    // Los contadores suben antes de encolar para que nunca queden por debajo
+    // del número real de tareas
+    {
+        lock_guard<mutex> lock(m_estado);
+        ++en_cola;
+        ++pendientes;
+    }
+    {
+        lock_guard<mutex> lock(colas[destino]->m);
+        colas[destino]->tareas.push_back(move(tarea));
+    }
+    cv_trabajo.notify_one();
+}
+
+void PoolHilos::esperar() {
+    unique_lock<mutex> lock(m_estado);
+    cv_fin.wait(lock, [this] { return pendientes == 0; });
+}
+
+// -----------------------------------------------------------------------------
+// 🔁 Bucle de trabajo
+// -----------------------------------------------------------------------------
+
+bool PoolHilos::tomar_tarea(unsigned indice, function<void()>& tarea) {
+    // 1. Cola propia, por el final
+    {
+        Cola& propia = *colas[indice];
+        lock_guard<mutex> lock(propia.m);
+        if (!propia.tareas.empty()) {
+            tarea = move(propia.tareas.back());
+            propia.tareas.pop_back();
+            return true;
+        }
+    }
+
+    // 2. Robo: colas ajenas, por el principio
+    for (size_t k = 1; k < colas.size(); ++k) {
+        Cola& victima = *colas[(indice + k) % colas.size()];
+        lock_guard<mutex> lock(victima.m);
+        if (!victima.tareas.empty()) {
+            tarea = move(victima.tareas.front());
+            victima.tareas.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolHilos::bucle(unsigned indice) {
+    pool_actual = this;
+    indice_hilo_actual = static_cast<int>(indice);
+
+    for (;;) {
+        function<void()> tarea;
+        if (tomar_tarea(indice, tarea)) {
+            {
+                lock_guard<mutex> lock(m_estado);
+                --en_cola;
+            }
+            tarea();
+
+            bool terminado;
+            {
+                lock_guard<mutex> lock(m_estado);
+                terminado = --pendientes == 0;
+            }
+            if (terminado) cv_fin.notify_all();
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_estado);
+        cv_trabajo.wait(lock, [this] { return detener || en_cola > 0; });
+        if (detener && en_cola == 0) return;
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef POOL_HILOS_HPP
+#define POOL_HILOS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// --- POOL DE HILOS CON ROBO DE TAREAS ---
+// Cada hilo tiene su propia cola: toma tareas del final de la suya (LIFO, datos
+// aún calientes en caché) y, cuando se queda sin trabajo, roba del principio de
+// las colas de los demás. Las tareas enviadas desde un hilo del pool van a la
+// cola de ese mismo hilo.
+class PoolHilos {
+private:
+    struct Cola {
+        mutex m;
+        deque<function<void()>> tareas;
+    };
+
+    vector<unique_ptr<Cola>> colas;
+    vector<thread> hilos;
+
+    mutex m_estado;
+    condition_variable cv_trabajo;  // Hay tareas en alguna cola
+    condition_variable cv_fin;      // No quedan tareas pendientes
+    size_t en_cola;                 // Tareas encoladas aún no tomadas
+    size_t pendientes;              // Tareas enviadas aún no terminadas
+    bool detener;
+    atomic<unsigned> siguiente_cola;
+
+    void bucle(unsigned indice);
+    bool tomar_tarea(unsigned indice, function<void()>& tarea);
+
+public:
+    // hilos = 0 usa tantos hilos como núcleos disponibles
+    explicit PoolHilos(unsigned hilos = 0);
+    ~PoolHilos();
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    void enviar(function<void()> tarea);
+    void esperar(); // Bloquea hasta que todas las tareas enviadas terminen
+
+    unsigned total_hilos() const { return static_cast<unsigned>(hilos.size()); }
+
+    // Índice del hilo del pool que ejecuta la llamada (-1 fuera del pool)
+    static int hilo_actual();
+};
+
+#endif // POOL_HILOS_HPP
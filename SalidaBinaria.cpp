@@ -0,0 +1,502 @@
+#include "SalidaBinaria.hpp"
+#include "LectorFuente.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    uint32_t alinear(uint32_t valor, uint32_t alineacion) {
+        return (valor + alineacion - 1) & ~(alineacion - 1);
+    }
+
+    template <typename T>
+    void poner(vector<uint8_t>& buf, size_t desplazamiento, const T& valor) {
+        memcpy(buf.data() + desplazamiento, &valor, sizeof(T));
+    }
+
+    uint32_t leer_dword(const vector<uint8_t>& buf, size_t pos) {
+        uint32_t v;
+        memcpy(&v, buf.data() + pos, 4);
+        return v;
+    }
+
+    void escribir_dword(vector<uint8_t>& buf, size_t pos, uint32_t v) {
+        memcpy(buf.data() + pos, &v, 4);
+    }
+
+    // Tabla de cadenas ELF: nombres terminados en '\0' tras un '\0' inicial
+    struct TablaCadenas {
+        string datos = string(1, '\0');
+
+        uint32_t agregar(string_view s) {
+            uint32_t pos = static_cast<uint32_t>(datos.size());
+            datos.append(s.data(), s.size());
+            datos.push_back('\0');
+            return pos;
+        }
+    };
+
+    // "00 " .. "FF ": tres caracteres por byte
+    struct TablaHex {
+        char par[256][3];
+    };
+
+    constexpr TablaHex construir_tabla_hex() {
+        TablaHex t = {};
+        const char digitos[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; ++i) {
+            t.par[i][0] = digitos[i >> 4];
+            t.par[i][1] = digitos[i & 0xF];
+            t.par[i][2] = ' ';
+        }
+        return t;
+    }
+
+    constexpr TablaHex TABLA_HEX = construir_tabla_hex();
+}
+
+// -----------------------------------------------------------------------------
+// 💾 Escritura de archivos
+// -----------------------------------------------------------------------------
+
+bool volcar_archivo(const string& ruta, const void* datos, size_t tamano, bool ejecutable) {
+    int fd = ::open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, ejecutable ? 0755 : 0644);
+    if (fd < 0) return false;
+
+    const char* p = static_cast<const char*>(datos);
+    while (tamano > 0) {
+        ssize_t escritos = ::write(fd, p, tamano);
+        if (escritos <= 0) {
+            ::close(fd);
+            return false;
+        }
+        p += escritos;
+        tamano -= static_cast<size_t>(escritos);
+    }
+    return ::close(fd) == 0;
+}
+
+bool actualizar_archivo(const string& ruta, string_view anterior, string_view nuevo,
+                        bool ejecutable, size_t& bytes_escritos) {
+    // Sin contenido previo se escribe entero
+    if (anterior.empty() || access(ruta.c_str(), F_OK) != 0) {
+        bytes_escritos = nuevo.size();
+        return volcar_archivo(ruta, nuevo.data(), nuevo.size(), ejecutable);
+    }
+
+    int fd = ::open(ruta.c_str(), O_WRONLY);
+    if (fd < 0) return false;
+
+    auto escribir_tramo = [&](size_t inicio, size_t fin) {
+        for (size_t pos = inicio; pos < fin;) {
+            ssize_t escritos = ::pwrite(fd, nuevo.data() + pos, fin - pos, static_cast<off_t>(pos));
+            if (escritos <= 0) return false;
+            pos += static_cast<size_t>(escritos);
+        }
+        bytes_escritos += fin - inicio;
+        return true;
+    };
+    bytes_escritos = 0;
+
+    // Con otro tamaño todo lo que sigue al prefijo común se ha desplazado
+    if (anterior.size() != nuevo.size()) {
+        size_t comun = 0;
+        const size_t limite = min(anterior.size(), nuevo.size());
+        while (comun < limite && anterior[comun] == nuevo[comun]) ++comun;
+        bool correcto = escribir_tramo(comun, nuevo.size()) &&
+                        ::ftruncate(fd, static_cast<off_t>(nuevo.size())) == 0;
+        return (::close(fd) == 0) && correcto;
+    }
+
+    // Mismo tamaño: tramos distintos; los huecos iguales de menos de 64 bytes
+    // se funden con el tramo siguiente para no multiplicar las llamadas
+    const size_t HUECO_MINIMO = 64;
+    size_t i = 0;
+    while (i < nuevo.size()) {
+        if (anterior[i] == nuevo[i]) { ++i; continue; }
+
+        size_t inicio = i, fin = i + 1, iguales = 0;
+        for (size_t j = fin; j < nuevo.size() && iguales < HUECO_MINIMO; ++j) {
+            if (anterior[j] == nuevo[j]) {
+                ++iguales;
+            } else {
+                fin = j + 1;
+                iguales = 0;
+            }
+        }
+
+        if (!escribir_tramo(inicio, fin)) {
+            ::close(fd);
+            return false;
+        }
+        i = fin;
+    }
+    return ::close(fd) == 0;
+}
+
+void formatear_hex(const vector<uint8_t>& codigo, string& salida) {
+    salida.resize(codigo.size() * 3 + 1);
+    char* p = &salida[0];
+    for (uint8_t byte : codigo) {
+        memcpy(p, TABLA_HEX.par[byte], 3);
+        p += 3;
+    }
+    *p = '\n';
+}
+
+// -----------------------------------------------------------------------------
+// 🌊 Salida continua
+// -----------------------------------------------------------------------------
+
+SalidaContinua::SalidaContinua() : fd(-1), hex(false), correcto(true) {}
+
+SalidaContinua::~SalidaContinua() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool SalidaContinua::abrir(const string& ruta, bool formato_hex) {
+    fd = ::open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    hex = formato_hex;
+    correcto = fd >= 0;
+    cuentas = ResumenSalidaContinua();
+    return correcto;
+}
+
+void SalidaContinua::escribir(uint64_t posicion, const uint8_t* datos, size_t n) {
+    const char* p = reinterpret_cast<const char*>(datos);
+    if (hex) {
+        texto.resize(n * 3);
+        for (size_t i = 0; i < n; ++i) memcpy(&texto[i * 3], TABLA_HEX.par[datos[i]], 3);
+        p = texto.data();
+        n *= 3;
+        posicion *= 3;
+    }
+    while (n > 0 && correcto) {
+        ssize_t escritos = ::pwrite(fd, p, n, static_cast<off_t>(posicion));
+        if (escritos <= 0) {
+            correcto = false;
+            break;
+        }
+        p += escritos;
+        n -= static_cast<size_t>(escritos);
+        posicion += static_cast<uint64_t>(escritos);
+    }
+}
+
+void SalidaContinua::soltar(deque<BloqueRetenido>::iterator bloque) {
+    escribir(bloque->inicio, bloque->bytes.data(), bloque->bytes.size());
+    if (libres.size() < 4) {
+        bloque->bytes.clear();
+        libres.push_back(move(bloque->bytes));
+    }
+    retenidos.erase(bloque);
+}
+
+void SalidaContinua::entregar(uint64_t inicio, vector<uint8_t>& bytes, uint32_t pendientes) {
+    ++cuentas.bloques;
+    cuentas.bytes = max<uint64_t>(cuentas.bytes, inicio + bytes.size());
+    if (pendientes == 0) {
+        escribir(inicio, bytes.data(), bytes.size());
+        bytes.clear();
+        return;
+    }
+
+    retenidos.push_back({inicio, move(bytes), pendientes});
+    if (libres.empty()) {
+        bytes = vector<uint8_t>();
+        bytes.reserve(TAMANO_BLOQUE);
+    } else {
+        bytes = move(libres.back());
+        libres.pop_back();
+    }
+    cuentas.retenidos_maximo = max<uint64_t>(cuentas.retenidos_maximo, retenidos.size());
+    if (retenidos.size() > MAXIMO_RETENIDOS) soltar(retenidos.begin());
+}
+
+void SalidaContinua::parchear(uint64_t posicion, const uint8_t* datos, size_t n) {
+    // El bloque que lo contiene es el último que empieza antes o en 'posicion'
+    auto siguiente = upper_bound(retenidos.begin(), retenidos.end(), posicion,
+                                 [](uint64_t p, const BloqueRetenido& b) { return p < b.inicio; });
+    if (siguiente != retenidos.begin()) {
+        auto bloque = prev(siguiente);
+        if (posicion - bloque->inicio < bloque->bytes.size()) {
+            memcpy(bloque->bytes.data() + (posicion - bloque->inicio), datos, n);
+            ++cuentas.parches_en_memoria;
+            if (--bloque->pendientes == 0) soltar(bloque);
+            return;
+        }
+    }
+    escribir(posicion, datos, n);
+    ++cuentas.parches_en_disco;
+}
+
+bool SalidaContinua::cerrar() {
+    if (fd < 0) return false;
+    while (!retenidos.empty()) soltar(retenidos.begin());
+    if (hex && correcto) {
+        const char salto = '\n';
+        correcto = ::pwrite(fd, &salto, 1, static_cast<off_t>(cuentas.bytes * 3)) == 1;
+    }
+    correcto &= ::close(fd) == 0;
+    fd = -1;
+    return correcto;
+}
+
+// -----------------------------------------------------------------------------
+// 📦 Construcción de ELF32
+// -----------------------------------------------------------------------------
+
+bool es_simbolo_entrada(string_view nombre) {
+    return igual_sin_mayusculas(nombre, "_start");
+}
+
+bool construir_elf32(ImagenELF& imagen, bool ejecutable, vector<uint8_t>& salida, string& error) {
+    // Índices fijos de sección: 1 .text, 2 .data, 3 .bss, 4 .symtab, 5 .strtab
+    const uint16_t SEC_TEXTO = 1, SEC_DATOS = 2, SEC_BSS = 3, SEC_SYMTAB = 4, SEC_STRTAB = 5;
+    const uint16_t indice_seccion[] = {SHN_UNDEF, SEC_TEXTO, SEC_DATOS, SEC_BSS};
+
+    const uint32_t tamano_texto = static_cast<uint32_t>(imagen.texto.size());
+    const uint32_t tamano_datos = static_cast<uint32_t>(imagen.datos.size());
+    const bool hay_datos = tamano_datos > 0 || imagen.tamano_bss > 0;
+
+    // 1. Disposición de .text/.data/.bss en el archivo y en memoria
+    const uint32_t total_phdr = ejecutable ? (hay_datos ? 2 : 1) : 0;
+    const uint32_t alineacion_texto = max<uint32_t>(imagen.alineacion_texto, 16);
+    const uint32_t off_texto = alinear(sizeof(Elf32_Ehdr) + total_phdr * sizeof(Elf32_Phdr), alineacion_texto);
+    const uint32_t alineacion_datos = max<uint32_t>(imagen.alineacion_datos, 4);
+    const uint32_t off_datos = alinear(off_texto + tamano_texto, max<uint32_t>(alineacion_datos, 16));
+
+    uint32_t direccion[4] = {0, 0, 0, 0}; // Por SeccionELF
+    if (ejecutable) {
+        direccion[1] = BASE_EJECUTABLE_ELF + off_texto;
+        // Página propia para datos, congruente con su desplazamiento en el archivo
+        direccion[2] = alinear(direccion[1] + tamano_texto, 0x1000) + (off_datos & 0xFFF);
+        direccion[3] = alinear(direccion[2] + tamano_datos, alineacion_datos);
+    }
+
+    // 2. Tabla de símbolos: nulo, símbolos de sección, locales y luego globales
+    TablaCadenas strtab;
+    vector<Elf32_Sym> symtab(1);
+    memset(&symtab[0], 0, sizeof(Elf32_Sym));
+    for (uint16_t sec = SEC_TEXTO; sec <= SEC_BSS; ++sec) {
+        Elf32_Sym s = {};
+        s.st_info = ELF32_ST_INFO(STB_LOCAL, STT_SECTION);
+        s.st_shndx = sec;
+        s.st_value = direccion[sec];
+        symtab.push_back(s);
+    }
+
+    vector<uint32_t> indice_simbolo(imagen.simbolos.size());
+    uint32_t primer_global = 0;
+    for (int pasada = 0; pasada < 2; ++pasada) {
+        const bool globales = pasada == 1;
+        if (globales) primer_global = static_cast<uint32_t>(symtab.size());
+        for (size_t i = 0; i < imagen.simbolos.size(); ++i) {
+            const SimboloELF& sim = imagen.simbolos[i];
+            bool es_global = sim.global || sim.seccion == SeccionELF::NINGUNA;
+            if (es_global != globales) continue;
+
+            Elf32_Sym s = {};
+            s.st_name = strtab.agregar(sim.nombre);
+            s.st_size = sim.tamano;
+            if (sim.seccion == SeccionELF::NINGUNA) {
+                s.st_info = ELF32_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+                s.st_shndx = SHN_UNDEF;
+            } else {
+                int sec = static_cast<int>(sim.seccion);
+                s.st_info = ELF32_ST_INFO(es_global ? STB_GLOBAL : STB_LOCAL,
+                                          sim.seccion == SeccionELF::TEXTO ? STT_FUNC : STT_OBJECT);
+                s.st_shndx = indice_seccion[sec];
+                s.st_value = direccion[sec] + sim.valor;
+            }
+            indice_simbolo[i] = static_cast<uint32_t>(symtab.size());
+            symtab.push_back(s);
+        }
+    }
+
+    // 3. Reubicaciones: al archivo (ET_REL) o aplicadas (ET_EXEC)
+    vector<Elf32_Rel> rel_texto, rel_datos;
+    for (const auto& r : imagen.reubicaciones) {
+        vector<uint8_t>& contenido = r.seccion == SeccionELF::DATOS ? imagen.datos : imagen.texto;
+        if (r.posicion + 4 > contenido.size()) {
+            error = "reubicación fuera de la sección";
+            return false;
+        }
+
+        if (!ejecutable) {
+            uint32_t sim = r.simbolo == ReubicacionELF::SIN_SIMBOLO
+                               ? static_cast<uint32_t>(r.destino) // Símbolo de sección 1..3
+                               : indice_simbolo[r.simbolo];
+            Elf32_Rel rel;
+            rel.r_offset = r.posicion;
+            rel.r_info = ELF32_R_INFO(sim, r.tipo);
+            (r.seccion == SeccionELF::DATOS ? rel_datos : rel_texto).push_back(rel);
+            continue;
+        }
+
+        uint32_t s;
+        if (r.simbolo == ReubicacionELF::SIN_SIMBOLO) {
+            s = direccion[static_cast<int>(r.destino)];
+        } else {
+            const SimboloELF& sim = imagen.simbolos[r.simbolo];
+            if (sim.seccion == SeccionELF::NINGUNA) {
+                error = "símbolo indefinido '" + string(sim.nombre) + "'";
+                return false;
+            }
+            s = direccion[static_cast<int>(sim.seccion)] + sim.valor;
+        }
+
+        uint32_t sumando = leer_dword(contenido, r.posicion);
+        uint32_t p = direccion[static_cast<int>(r.seccion)] + r.posicion;
+        escribir_dword(contenido, r.posicion, r.tipo == R_386_PC32 ? s + sumando - p : s + sumando);
+    }
+
+    // 4. Cabeceras de sección y nombres
+    TablaCadenas shstrtab;
+    vector<Elf32_Shdr> secciones(1);
+    secciones.reserve(10); // Las referencias devueltas por nueva_seccion deben seguir siendo válidas
+    memset(&secciones[0], 0, sizeof(Elf32_Shdr));
+    auto nueva_seccion = [&](const char* nombre, uint32_t tipo, uint32_t flags) -> Elf32_Shdr& {
+        Elf32_Shdr sh = {};
+        sh.sh_name = shstrtab.agregar(nombre);
+        sh.sh_type = tipo;
+        sh.sh_flags = flags;
+        sh.sh_addralign = 1;
+        secciones.push_back(sh);
+        return secciones.back();
+    };
+
+    Elf32_Shdr& sh_texto = nueva_seccion(".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR);
+    sh_texto.sh_addr = direccion[1];
+    sh_texto.sh_offset = off_texto;
+    sh_texto.sh_size = tamano_texto;
+    sh_texto.sh_addralign = alineacion_texto;
+
+    Elf32_Shdr& sh_datos = nueva_seccion(".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE);
+    sh_datos.sh_addr = direccion[2];
+    sh_datos.sh_offset = off_datos;
+    sh_datos.sh_size = tamano_datos;
+    sh_datos.sh_addralign = alineacion_datos;
+
+    Elf32_Shdr& sh_bss = nueva_seccion(".bss", SHT_NOBITS, SHF_ALLOC | SHF_WRITE);
+    sh_bss.sh_addr = direccion[3];
+    sh_bss.sh_offset = off_datos + tamano_datos;
+    sh_bss.sh_size = imagen.tamano_bss;
+    sh_bss.sh_addralign = alineacion_datos;
+
+    uint32_t off = alinear(off_datos + tamano_datos, 4);
+
+    Elf32_Shdr& sh_symtab = nueva_seccion(".symtab", SHT_SYMTAB, 0);
+    sh_symtab.sh_offset = off;
+    sh_symtab.sh_size = static_cast<uint32_t>(symtab.size() * sizeof(Elf32_Sym));
+    sh_symtab.sh_link = SEC_STRTAB;
+    sh_symtab.sh_info = primer_global;
+    sh_symtab.sh_addralign = 4;
+    sh_symtab.sh_entsize = sizeof(Elf32_Sym);
+    off += sh_symtab.sh_size;
+
+    Elf32_Shdr& sh_strtab = nueva_seccion(".strtab", SHT_STRTAB, 0);
+    sh_strtab.sh_offset = off;
+    sh_strtab.sh_size = static_cast<uint32_t>(strtab.datos.size());
+    off = alinear(off + sh_strtab.sh_size, 4);
+
+    uint32_t off_rel_texto = 0, off_rel_datos = 0;
+    if (!ejecutable) {
+        Elf32_Shdr& sh_rt = nueva_seccion(".rel.text", SHT_REL, 0);
+        sh_rt.sh_offset = off_rel_texto = off;
+        sh_rt.sh_size = static_cast<uint32_t>(rel_texto.size() * sizeof(Elf32_Rel));
+        sh_rt.sh_link = SEC_SYMTAB;
+        sh_rt.sh_info = SEC_TEXTO;
+        sh_rt.sh_addralign = 4;
+        sh_rt.sh_entsize = sizeof(Elf32_Rel);
+        off += sh_rt.sh_size;
+
+        Elf32_Shdr& sh_rd = nueva_seccion(".rel.data", SHT_REL, 0);
+        sh_rd.sh_offset = off_rel_datos = off;
+        sh_rd.sh_size = static_cast<uint32_t>(rel_datos.size() * sizeof(Elf32_Rel));
+        sh_rd.sh_link = SEC_SYMTAB;
+        sh_rd.sh_info = SEC_DATOS;
+        sh_rd.sh_addralign = 4;
+        sh_rd.sh_entsize = sizeof(Elf32_Rel);
+        off += sh_rd.sh_size;
+    }
+
+    const uint16_t indice_shstrtab = static_cast<uint16_t>(secciones.size());
+    Elf32_Shdr& sh_shstrtab = nueva_seccion(".shstrtab", SHT_STRTAB, 0);
+    sh_shstrtab.sh_offset = off;
+    sh_shstrtab.sh_size = static_cast<uint32_t>(shstrtab.datos.size());
+    off = alinear(off + sh_shstrtab.sh_size, 4);
+
+    const uint32_t off_shdr = off;
+    const uint32_t tamano_total = off_shdr + static_cast<uint32_t>(secciones.size() * sizeof(Elf32_Shdr));
+
+    // 5. Cabecera ELF y de programa
+    Elf32_Ehdr eh = {};
+    memcpy(eh.e_ident, ELFMAG, SELFMAG);
+    eh.e_ident[EI_CLASS] = ELFCLASS32;
+    eh.e_ident[EI_DATA] = ELFDATA2LSB;
+    eh.e_ident[EI_VERSION] = EV_CURRENT;
+    eh.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    eh.e_type = ejecutable ? ET_EXEC : ET_REL;
+    eh.e_machine = EM_386;
+    eh.e_version = EV_CURRENT;
+    eh.e_phoff = total_phdr ? sizeof(Elf32_Ehdr) : 0;
+    eh.e_shoff = off_shdr;
+    eh.e_ehsize = sizeof(Elf32_Ehdr);
+    eh.e_phentsize = total_phdr ? sizeof(Elf32_Phdr) : 0;
+    eh.e_phnum = static_cast<uint16_t>(total_phdr);
+    eh.e_shentsize = sizeof(Elf32_Shdr);
+    eh.e_shnum = static_cast<uint16_t>(secciones.size());
+    eh.e_shstrndx = indice_shstrtab;
+
+    if (ejecutable) {
+        eh.e_entry = direccion[1];
+        for (const auto& sim : imagen.simbolos) {
+            if (es_simbolo_entrada(sim.nombre) && sim.seccion == SeccionELF::TEXTO) {
+                eh.e_entry = direccion[1] + sim.valor;
+                break;
+            }
+        }
+    }
+
+    // 6. Volcado al búfer de salida
+    salida.assign(tamano_total, 0);
+    poner(salida, 0, eh);
+
+    if (ejecutable) {
+        Elf32_Phdr ph = {};
+        ph.p_type = PT_LOAD;
+        ph.p_offset = 0;
+        ph.p_vaddr = ph.p_paddr = BASE_EJECUTABLE_ELF;
+        ph.p_filesz = ph.p_memsz = off_texto + tamano_texto;
+        ph.p_flags = PF_R | PF_X;
+        ph.p_align = 0x1000;
+        poner(salida, sizeof(Elf32_Ehdr), ph);
+
+        if (hay_datos) {
+            Elf32_Phdr pd = {};
+            pd.p_type = PT_LOAD;
+            pd.p_offset = off_datos;
+            pd.p_vaddr = pd.p_paddr = direccion[2];
+            pd.p_filesz = tamano_datos;
+            pd.p_memsz = direccion[3] + imagen.tamano_bss - direccion[2];
+            pd.p_flags = PF_R | PF_W;
+            pd.p_align = 0x1000;
+            poner(salida, sizeof(Elf32_Ehdr) + sizeof(Elf32_Phdr), pd);
+        }
+    }
+
+    if (tamano_texto) memcpy(salida.data() + off_texto, imagen.texto.data(), tamano_texto);
+    if (tamano_datos) memcpy(salida.data() + off_datos, imagen.datos.data(), tamano_datos);
+    memcpy(salida.data() + sh_symtab.sh_offset, symtab.data(), sh_symtab.sh_size);
+    memcpy(salida.data() + sh_strtab.sh_offset, strtab.datos.data(), sh_strtab.sh_size);
+    if (!rel_texto.empty()) memcpy(salida.data() + off_rel_texto, rel_texto.data(), rel_texto.size() * sizeof(Elf32_Rel));
+    if (!rel_datos.empty()) memcpy(salida.data() + off_rel_datos, rel_datos.data(), rel_datos.size() * sizeof(Elf32_Rel));
+    memcpy(salida.data() + sh_shstrtab.sh_offset, shstrtab.datos.data(), sh_shstrtab.sh_size);
+    memcpy(salida.data() + off_shdr, secciones.data(), secciones.size() * sizeof(Elf32_Shdr));
+
+    return true;
+}
@@ -0,0 +1,186 @@
+#ifndef SALIDA_BINARIA_HPP
+#define SALIDA_BINARIA_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// --- ESCRITURA DE ARCHIVOS ---
+// Escribe el búfer completo con una sola llamada a write() (repetida sólo si el
+// sistema acepta una escritura parcial). 'ejecutable' crea el archivo con 0755.
+bool volcar_archivo(const string& ruta, const void* datos, size_t tamano, bool ejecutable = false);
+
+// Deja en 'ruta' el contenido 'nuevo' sabiendo que ahora contiene 'anterior':
+// sólo se reescriben (pwrite) los tramos distintos o, si cambia el tamaño,
+// lo que sigue al prefijo común
+bool actualizar_archivo(const string& ruta, string_view anterior, string_view nuevo,
+                        bool ejecutable, size_t& bytes_escritos);
+
+// Formatea el código como texto "XX XX ... \n" con una tabla de búsqueda,
+// rellenando 'salida' de una vez
+void formatear_hex(const vector<uint8_t>& codigo, string& salida);
+
+// --- SALIDA CONTINUA ---
+struct ResumenSalidaContinua {
+    uint64_t bytes = 0;                 // Tamaño del código escrito
+    uint64_t bloques = 0;               // Bloques entregados
+    uint64_t retenidos_maximo = 0;      // Bloques esperando parches a la vez, como mucho
+    uint64_t parches_en_memoria = 0;    // Aplicados sobre un bloque retenido
+    uint64_t parches_en_disco = 0;      // Escritos con pwrite sobre un bloque ya escrito
+};
+
+// Archivo de salida (bin o hex) que se escribe por bloques mientras se
+// ensambla. Cada bloque llega con el número de campos que aún esperan una
+// etiqueta: sin ninguno se escribe enseguida; con alguno se retiene hasta su
+// último parche. Pasados MAXIMO_RETENIDOS se escribe el más antiguo y sus
+// parches van después directamente al archivo (pwrite).
+class SalidaContinua {
+public:
+    static constexpr size_t TAMANO_BLOQUE = 64 << 10;
+    static constexpr size_t MAXIMO_RETENIDOS = 64;
+
+private:
+    struct BloqueRetenido {
+        uint64_t inicio;        // Posición de su primer byte en el código
+        vector<uint8_t> bytes;
+        uint32_t pendientes;    // Campos aún sin parchear
+    };
+
+    int fd;
+    bool hex;                           // Tres caracteres por byte ("XX ")
+    bool correcto;
+    deque<BloqueRetenido> retenidos;    // Ordenados por posición
+    vector<vector<uint8_t>> libres;     // Búferes de bloques ya escritos
+    string texto;                       // Búfer de formateo hex
+    ResumenSalidaContinua cuentas;
+
+    void escribir(uint64_t posicion, const uint8_t* datos, size_t n);
+    void soltar(deque<BloqueRetenido>::iterator bloque);
+
+public:
+    SalidaContinua();
+    ~SalidaContinua();
+    SalidaContinua(const SalidaContinua&) = delete;
+    SalidaContinua& operator=(const SalidaContinua&) = delete;
+
+    bool abrir(const string& ruta, bool formato_hex);
+    // Entrega el bloque que empieza en 'inicio', en orden de posición. 'bytes'
+    // se vacía y queda listo (con capacidad) para la siguiente ventana.
+    void entregar(uint64_t inicio, vector<uint8_t>& bytes, uint32_t pendientes);
+    // Parchea n bytes de un bloque ya entregado; cuenta como uno de sus pendientes
+    void parchear(uint64_t posicion, const uint8_t* datos, size_t n);
+    // Escribe los bloques aún retenidos (sus campos sin resolver quedan a 0) y
+    // cierra; false si falló alguna escritura
+    bool cerrar();
+
+    const ResumenSalidaContinua& resumen() const { return cuentas; }
+};
+
+// --- SERIALIZACIÓN BINARIA ---
+// Enteros little endian y cadenas con longitud u32, para los formatos de las
+// cachés en disco
+struct EscritorBinario {
+    string& s;
+
+    void u8(uint8_t v) { s.push_back(static_cast<char>(v)); }
+    void u32(uint32_t v) { for (int k = 0; k < 4; ++k) u8(static_cast<uint8_t>(v >> (8 * k))); }
+    void u64(uint64_t v) { for (int k = 0; k < 8; ++k) u8(static_cast<uint8_t>(v >> (8 * k))); }
+    void bytes(const void* datos, size_t n) { s.append(static_cast<const char*>(datos), n); }
+    void texto(string_view t) { u32(static_cast<uint32_t>(t.size())); bytes(t.data(), t.size()); }
+};
+
+// Cada lectura comprueba el tamaño; tras el primer fallo 'ok' queda a false
+// y todo lo que se lea vale 0
+struct LectorBinario {
+    string_view d;
+    size_t p = 0;
+    bool ok = true;
+
+    bool hay(size_t n) {
+        if (!ok || d.size() - p < n) ok = false;
+        return ok;
+    }
+    uint8_t u8() { return hay(1) ? static_cast<uint8_t>(d[p++]) : 0; }
+    uint32_t u32() {
+        uint32_t v = 0;
+        for (int k = 0; k < 4; ++k) v |= static_cast<uint32_t>(u8()) << (8 * k);
+        return v;
+    }
+    uint64_t u64() {
+        uint64_t v = 0;
+        for (int k = 0; k < 8; ++k) v |= static_cast<uint64_t>(u8()) << (8 * k);
+        return v;
+    }
+    string_view texto() {
+        uint32_t n = u32();
+        if (!hay(n)) return {};
+        string_view t = d.substr(p, n);
+        p += n;
+        return t;
+    }
+    // Número de elementos de una tabla: no puede superar los bytes que quedan
+    uint32_t cuenta(size_t bytes_por_elemento) {
+        uint32_t n = u32();
+        if (ok && n > (d.size() - p) / bytes_por_elemento) ok = false;
+        return ok ? n : 0;
+    }
+};
+
+// --- IMAGEN ELF32 ---
+enum class SeccionELF : uint8_t {
+    NINGUNA = 0,    // Símbolo indefinido (externo)
+    TEXTO,
+    DATOS,
+    BSS
+};
+
+struct SimboloELF {
+    string_view nombre;
+    uint32_t valor;         // Desplazamiento dentro de su sección
+    uint32_t tamano;
+    SeccionELF seccion;
+    bool global;
+};
+
+struct ReubicacionELF {
+    static constexpr uint32_t SIN_SIMBOLO = 0xFFFFFFFFu;
+
+    SeccionELF seccion;     // Sección donde está el campo a parchear
+    uint32_t posicion;      // Desplazamiento del campo dentro de esa sección
+    uint8_t tipo;           // R_386_32 o R_386_PC32
+    SeccionELF destino;     // Sección cuyo inicio se suma (si simbolo == SIN_SIMBOLO)
+    uint32_t simbolo;       // Índice en ImagenELF::simbolos o SIN_SIMBOLO
+};
+
+// Contenido a empaquetar. Los campos reubicables llevan ya escrito su sumando
+// implícito (formato REL): el desplazamiento dentro de 'destino', o el sumando
+// para los símbolos indefinidos.
+struct ImagenELF {
+    vector<uint8_t> texto;
+    vector<uint8_t> datos;
+    uint32_t tamano_bss = 0;
+    uint32_t alineacion_texto = 16;     // Al menos 16; más si el código usa ALIGN mayores
+    uint32_t alineacion_datos = 4;      // De .data y .bss: al menos 4; más con ALIGN mayores
+    vector<SimboloELF> simbolos;
+    vector<ReubicacionELF> reubicaciones;
+};
+
+// Dirección de carga del ejecutable (la habitual de ld para i386)
+constexpr uint32_t BASE_EJECUTABLE_ELF = 0x08048000u;
+
+// Construye un objeto reubicable (ET_REL) o un ejecutable estático (ET_EXEC).
+// En el ejecutable las reubicaciones se aplican sobre las secciones y la
+// entrada es el símbolo _start (o el inicio de .text). Devuelve false y
+// describe el problema en 'error' si hay referencias sin resolver.
+bool construir_elf32(ImagenELF& imagen, bool ejecutable, vector<uint8_t>& salida, string& error);
+
+// Punto de entrada del programa: _start sin distinguir mayúsculas (_START).
+// Lo comparten el ejecutable ELF y el grafo de flujo de -O2
+bool es_simbolo_entrada(string_view nombre);
+
+#endif // SALIDA_BINARIA_HPP
@@ -0,0 +1,302 @@
+#include "SimbolosPerfilado.hpp"
+
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+// 📌 Escritor con búfer
+// -----------------------------------------------------------------------------
+
+EscritorBufer::EscritorBufer() : fd(-1), correcto(true), escritos(0) {}
+
+EscritorBufer::~EscritorBufer() {
+    if (fd >= 0) cerrar();
+}
+
+bool EscritorBufer::abrir(const string& ruta, bool anadir) {
+    if (fd >= 0) cerrar();
+    fd = ::open(ruta.c_str(), O_WRONLY | O_CREAT | (anadir ? O_APPEND : O_TRUNC), 0644);
+    correcto = fd >= 0;
+    escritos = 0;
+    bufer.clear();
+    bufer.reserve(CAPACIDAD);
+    return correcto;
+}
+
+bool EscritorBufer::volcar() {
+    if (fd < 0) return correcto; // En memoria: el búfer es el resultado
+    const char* p = bufer.data();
+    size_t pendiente = bufer.size();
+    while (pendiente > 0 && correcto) {
+        ssize_t n = ::write(fd, p, pendiente);
+        if (n <= 0) {
+            correcto = false;
+            break;
+        }
+        p += n;
+        pendiente -= static_cast<size_t>(n);
+    }
+    bufer.clear();
+    return correcto;
+}
+
+bool EscritorBufer::cerrar() {
+    volcar();
+    if (fd >= 0) {
+        if (::close(fd) != 0) correcto = false;
+        fd = -1;
+    }
+    return correcto;
+}
+
+void EscritorBufer::escribir(const void* datos, size_t n) {
+    bufer.append(static_cast<const char*>(datos), n);
+    escritos += n;
+    if (bufer.size() >= CAPACIDAD) volcar();
+}
+
+void EscritorBufer::hex(uint64_t valor) {
+    char cifras[16];
+    int n = 0;
+    do {
+        cifras[n++] = "0123456789abcdef"[valor & 0xF];
+        valor >>= 4;
+    } while (valor != 0);
+    while (n > 0) caracter(cifras[--n]);
+}
+
+void EscritorBufer::ceros(size_t n) {
+    bufer.append(n, '\0');
+    escritos += n;
+    if (bufer.size() >= CAPACIDAD) volcar();
+}
+
+// -----------------------------------------------------------------------------
+// 🔥 Mapa de perf
+// -----------------------------------------------------------------------------
+
+bool escribir_mapa_perf(const vector<SimboloCodigo>& simbolos, uint64_t direccion, const string& ruta) {
+    // Se añade al final: un proceso puede cargar varios códigos. Las líneas
+    // salen en un solo write() por cada 64 KiB, sin intercalarse con las de
+    // otro hilo que escriba a la vez
+    static mutex cerrojo;
+    lock_guard<mutex> bloqueo(cerrojo);
+
+    EscritorBufer mapa;
+    if (!mapa.abrir(ruta.empty() ? "/tmp/perf-" + to_string(getpid()) + ".map" : ruta, true)) return false;
+    for (const SimboloCodigo& s : simbolos) {
+        if (s.tamano == 0) continue;
+        mapa.hex(direccion + s.inicio);
+        mapa.caracter(' ');
+        mapa.hex(s.tamano);
+        mapa.caracter(' ');
+        mapa.escribir(s.nombre);
+        mapa.caracter('\n');
+    }
+    return mapa.cerrar();
+}
+
+// -----------------------------------------------------------------------------
+// 🧾 Archivo de símbolos ELF
+// -----------------------------------------------------------------------------
+
+namespace {
+    template <bool ELF64>
+    struct TiposELF {
+        using Ehdr = conditional_t<ELF64, Elf64_Ehdr, Elf32_Ehdr>;
+        using Shdr = conditional_t<ELF64, Elf64_Shdr, Elf32_Shdr>;
+        using Sym = conditional_t<ELF64, Elf64_Sym, Elf32_Sym>;
+        static constexpr uint8_t CLASE = ELF64 ? ELFCLASS64 : ELFCLASS32;
+        static constexpr uint16_t MAQUINA = ELF64 ? EM_X86_64 : EM_386;
+    };
+
+    template <bool ELF64>
+    void construir_simbolos(const vector<SimboloCodigo>& simbolos, uint64_t direccion, uint64_t tamano,
+                            EscritorBufer& salida) {
+        /*
+            Secciones: 0 nula, 1 .text (NOBITS: sólo dirección y tamaño),
+            2 .symtab, 3 .strtab, 4 .shstrtab. Primero el encabezado, después
+            los contenidos y al final la tabla de secciones, en orden, así que
+            todos los desplazamientos se conocen antes de empezar a escribir.
+        */
+        using T = TiposELF<ELF64>;
+        const uint16_t SEC_TEXTO = 1, SEC_SYMTAB = 2, SEC_STRTAB = 3, SEC_SHSTRTAB = 4, TOTAL_SECCIONES = 5;
+
+        // Locales antes que globales, como pide ELF
+        string strtab(1, '\0');
+        vector<typename T::Sym> symtab(1);
+        memset(&symtab[0], 0, sizeof(typename T::Sym));
+        uint32_t primer_global = 1;
+        for (int globales = 0; globales < 2; ++globales) {
+            if (globales) primer_global = static_cast<uint32_t>(symtab.size());
+            for (const SimboloCodigo& s : simbolos) {
+                if (s.global != (globales == 1)) continue;
+                typename T::Sym sym;
+                memset(&sym, 0, sizeof(sym));
+                sym.st_name = static_cast<uint32_t>(strtab.size());
+                sym.st_value = direccion + s.inicio;
+                sym.st_size = s.tamano;
+                sym.st_info = ELF32_ST_INFO(s.global ? STB_GLOBAL : STB_LOCAL, STT_FUNC);
+                sym.st_shndx = SEC_TEXTO;
+                symtab.push_back(sym);
+                strtab.append(s.nombre.data(), s.nombre.size());
+                strtab.push_back('\0');
+            }
+        }
+        const char shstrtab[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+        const uint32_t nombre_seccion[] = {0, 1, 7, 15, 23};
+
+        const uint64_t alineacion = ELF64 ? 8 : 4;
+        auto alinear = [alineacion](uint64_t v) { return (v + alineacion - 1) & ~(alineacion - 1); };
+        const uint64_t off_symtab = alinear(sizeof(typename T::Ehdr));
+        const uint64_t bytes_symtab = symtab.size() * sizeof(typename T::Sym);
+        const uint64_t off_strtab = off_symtab + bytes_symtab;
+        const uint64_t off_shstrtab = off_strtab + strtab.size();
+        const uint64_t off_secciones = alinear(off_shstrtab + sizeof(shstrtab));
+
+        typename T::Ehdr eh;
+        memset(&eh, 0, sizeof(eh));
+        memcpy(eh.e_ident, ELFMAG, SELFMAG);
+        eh.e_ident[EI_CLASS] = T::CLASE;
+        eh.e_ident[EI_DATA] = ELFDATA2LSB;
+        eh.e_ident[EI_VERSION] = EV_CURRENT;
+        eh.e_type = ET_EXEC; // Direcciones absolutas: no hay nada que reubicar
+        eh.e_machine = T::MAQUINA;
+        eh.e_version = EV_CURRENT;
+        eh.e_shoff = off_secciones;
+        eh.e_ehsize = sizeof(typename T::Ehdr);
+        eh.e_shentsize = sizeof(typename T::Shdr);
+        eh.e_shnum = TOTAL_SECCIONES;
+        eh.e_shstrndx = SEC_SHSTRTAB;
+
+        vector<typename T::Shdr> secciones(TOTAL_SECCIONES);
+        memset(secciones.data(), 0, secciones.size() * sizeof(typename T::Shdr));
+        for (uint16_t i = 1; i < TOTAL_SECCIONES; ++i) secciones[i].sh_name = nombre_seccion[i];
+
+        secciones[SEC_TEXTO].sh_type = SHT_NOBITS;
+        secciones[SEC_TEXTO].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+        secciones[SEC_TEXTO].sh_addr = direccion;
+        secciones[SEC_TEXTO].sh_offset = off_symtab;
+        secciones[SEC_TEXTO].sh_size = tamano;
+        secciones[SEC_TEXTO].sh_addralign = 1;
+
+        secciones[SEC_SYMTAB].sh_type = SHT_SYMTAB;
+        secciones[SEC_SYMTAB].sh_offset = off_symtab;
+        secciones[SEC_SYMTAB].sh_size = bytes_symtab;
+        secciones[SEC_SYMTAB].sh_link = SEC_STRTAB;
+        secciones[SEC_SYMTAB].sh_info = primer_global;
+        secciones[SEC_SYMTAB].sh_addralign = alineacion;
+        secciones[SEC_SYMTAB].sh_entsize = sizeof(typename T::Sym);
+
+        secciones[SEC_STRTAB].sh_type = SHT_STRTAB;
+        secciones[SEC_STRTAB].sh_offset = off_strtab;
+        secciones[SEC_STRTAB].sh_size = strtab.size();
+        secciones[SEC_STRTAB].sh_addralign = 1;
+
+        secciones[SEC_SHSTRTAB].sh_type = SHT_STRTAB;
+        secciones[SEC_SHSTRTAB].sh_offset = off_shstrtab;
+        secciones[SEC_SHSTRTAB].sh_size = sizeof(shstrtab);
+        secciones[SEC_SHSTRTAB].sh_addralign = 1;
+
+        const uint64_t inicio = salida.posicion();
+        salida.escribir(&eh, sizeof(eh));
+        salida.ceros(off_symtab - (salida.posicion() - inicio));
+        salida.escribir(symtab.data(), bytes_symtab);
+        salida.escribir(strtab);
+        salida.escribir(shstrtab, sizeof(shstrtab));
+        salida.ceros(off_secciones - (salida.posicion() - inicio));
+        salida.escribir(secciones.data(), secciones.size() * sizeof(typename T::Shdr));
+    }
+}
+
+void construir_simbolos_elf(const vector<SimboloCodigo>& simbolos, uint64_t direccion, uint64_t tamano,
+                            bool elf64, EscritorBufer& salida) {
+    if (elf64) construir_simbolos<true>(simbolos, direccion, tamano, salida);
+    else construir_simbolos<false>(simbolos, direccion, tamano, salida);
+}
+
+// -----------------------------------------------------------------------------
+// 🐞 Interfaz JIT de GDB
+// -----------------------------------------------------------------------------
+
+// Nombres y disposición fijados por GDB ("JIT Compilation Interface"): los
+// busca por nombre en el proceso y pone un punto de ruptura en la función
+extern "C" {
+    enum AccionJit : uint32_t { JIT_NOACTION = 0, JIT_REGISTER_FN, JIT_UNREGISTER_FN };
+
+    struct jit_code_entry {
+        jit_code_entry* next_entry;
+        jit_code_entry* prev_entry;
+        const char* symfile_addr;
+        uint64_t symfile_size;
+    };
+
+    struct jit_descriptor {
+        uint32_t version;
+        uint32_t action_flag;
+        jit_code_entry* relevant_entry;
+        jit_code_entry* first_entry;
+    };
+
+    __attribute__((noinline, used)) void __jit_debug_register_code() {
+        __asm__ volatile("" ::: "memory"); // Que no se elimine la llamada
+    }
+
+    __attribute__((used)) jit_descriptor __jit_debug_descriptor = {1, JIT_NOACTION, nullptr, nullptr};
+}
+
+namespace {
+    struct RegistroGdb {
+        jit_code_entry entrada;
+        string archivo;     // Debe vivir mientras esté registrado
+    };
+
+    mutex cerrojo_gdb;
+    unordered_map<uint64_t, unique_ptr<RegistroGdb>> registros_gdb;
+    uint64_t siguiente_registro = 1;
+}
+
+uint64_t registrar_simbolos_gdb(const vector<SimboloCodigo>& simbolos, uint64_t direccion, uint64_t tamano) {
+    auto registro = make_unique<RegistroGdb>();
+    EscritorBufer archivo;
+    construir_simbolos_elf(simbolos, direccion, tamano, sizeof(void*) == 8, archivo);
+    registro->archivo.swap(archivo.datos());
+
+    jit_code_entry& e = registro->entrada;
+    e.symfile_addr = registro->archivo.data();
+    e.symfile_size = registro->archivo.size();
+    e.prev_entry = nullptr;
+
+    lock_guard<mutex> bloqueo(cerrojo_gdb);
+    e.next_entry = __jit_debug_descriptor.first_entry;
+    if (e.next_entry) e.next_entry->prev_entry = &e;
+    __jit_debug_descriptor.first_entry = &e;
+    __jit_debug_descriptor.relevant_entry = &e;
+    __jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+
+    const uint64_t id = siguiente_registro++;
+    registros_gdb.emplace(id, move(registro));
+    return id;
+}
+
+void retirar_simbolos_gdb(uint64_t registro) {
+    lock_guard<mutex> bloqueo(cerrojo_gdb);
+    auto it = registros_gdb.find(registro);
+    if (it == registros_gdb.end()) return;
+
+    jit_code_entry& e = it->second->entrada;
+    if (e.prev_entry) e.prev_entry->next_entry = e.next_entry;
+    else __jit_debug_descriptor.first_entry = e.next_entry;
+    if (e.next_entry) e.next_entry->prev_entry = e.prev_entry;
+    __jit_debug_descriptor.relevant_entry = &e;
+    __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+    registros_gdb.erase(it);
+}
@@ -0,0 +1,80 @@
+#ifndef SIMBOLOS_PERFILADO_HPP
+#define SIMBOLOS_PERFILADO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+using namespace std;
+
+// --- ESCRITOR CON BÚFER ---
+// Acumula lo escrito en un búfer. Con un archivo abierto lo vuelca con write()
+// cada vez que pasa de CAPACIDAD y al cerrar; sin archivo, todo queda en
+// memoria (datos()). Lo usan tanto el mapa de perf como el archivo de
+// símbolos de GDB.
+class EscritorBufer {
+private:
+    static constexpr size_t CAPACIDAD = 64 << 10;
+
+    int fd;
+    bool correcto;
+    uint64_t escritos;      // Bytes escritos desde el principio (volcados o no)
+    string bufer;
+
+    bool volcar();
+
+public:
+    EscritorBufer();
+    ~EscritorBufer();
+    EscritorBufer(const EscritorBufer&) = delete;
+    EscritorBufer& operator=(const EscritorBufer&) = delete;
+
+    // 'anadir' escribe al final del archivo (O_APPEND) en lugar de vaciarlo
+    bool abrir(const string& ruta, bool anadir = false);
+    // Vuelca lo pendiente y cierra; false si falló alguna escritura
+    bool cerrar();
+
+    void escribir(const void* datos, size_t n);
+    void escribir(string_view texto) { escribir(texto.data(), texto.size()); }
+    void caracter(char c) {
+        bufer.push_back(c);
+        ++escritos;
+        if (bufer.size() >= CAPACIDAD) volcar();
+    }
+    void hex(uint64_t valor);       // Sin prefijo, en minúsculas
+    void ceros(size_t n);
+
+    uint64_t posicion() const { return escritos; }
+    // Sin archivo: todo lo escrito
+    const string& datos() const { return bufer; }
+    string& datos() { return bufer; }
+};
+
+// --- MAPA DE PERF ---
+// Añade una línea "inicio tamaño nombre" (en hexadecimal) por etiqueta de un
+// código cargado en 'direccion'. Sin ruta se usa /tmp/perf-<pid>.map, donde
+// perf report busca los símbolos del código generado por este proceso. Las
+// etiquetas de tamaño 0 (al final del código) no se escriben.
+bool escribir_mapa_perf(const vector<SimboloCodigo>& simbolos, uint64_t direccion, const string& ruta = "");
+
+// --- ARCHIVO DE SÍMBOLOS ELF ---
+// Objeto ELF sin código: una sección .text SHT_NOBITS en 'direccion' de
+// 'tamano' bytes y un símbolo de función por etiqueta, con su dirección
+// absoluta. 'elf64' elige la clase (ELF64 x86-64 o ELF32 i386), que debe
+// coincidir con la del proceso que ejecuta el código.
+void construir_simbolos_elf(const vector<SimboloCodigo>& simbolos, uint64_t direccion, uint64_t tamano,
+                            bool elf64, EscritorBufer& salida);
+
+// --- INTERFAZ JIT DE GDB ---
+// Registra el archivo de símbolos (de la clase del proceso) en
+// __jit_debug_descriptor y avisa a GDB llamando a __jit_debug_register_code.
+// Devuelve un identificador para retirar_simbolos_gdb, que hay que llamar
+// antes de liberar o reutilizar la memoria del código.
+uint64_t registrar_simbolos_gdb(const vector<SimboloCodigo>& simbolos, uint64_t direccion, uint64_t tamano);
+void retirar_simbolos_gdb(uint64_t registro);
+
+#endif // SIMBOLOS_PERFILADO_HPP
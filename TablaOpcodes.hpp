@@ -0,0 +1,484 @@
+#ifndef TABLA_OPCODES_HPP
+#define TABLA_OPCODES_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+// --- IDENTIFICADORES DE MNEMÓNICOS ---
+// Cada mnemónico (y sus alias, p. ej. JZ/JE) se reduce a un identificador denso
+// que indexa directamente la tabla de formas de codificación.
+enum class Mnemonico : uint8_t {
+    DESCONOCIDO = 0,
+
+    // Directivas
+    SECTION, GLOBAL, EXTERN, INCLUDE, ALIGN,
+    DB, DW, DD, TIMES, RESB, RESW, RESD, INCBIN,
+
+    // Transferencia de datos
+    MOV, LEA, PUSH, POP, XCHG,
+
+    // Aritmética y lógica
+    ADD, OR, ADC, SBB, AND, SUB, XOR, CMP, TEST,
+    INC, DEC, NOT, NEG, MUL, IMUL, DIV, IDIV,
+    ROL, ROR, SHL, SHR, SAR,
+
+    // Control de flujo
+    JMP, CALL, RET, INT,
+    JO, JNO, JB, JAE, JE, JNE, JBE, JA,
+    JS, JNS, JP, JNP, JL, JGE, JLE, JG,
+
+    // Vectoriales (SSE/SSE2; PMULLD es de SSE4.1)
+    MOVDQA, MOVDQU, MOVAPS, MOVUPS,
+    PADDB, PADDW, PADDD, PADDQ, PSUBB, PSUBW, PSUBD, PSUBQ, PMULLW, PMULLD,
+    PAND, PANDN, POR, PXOR, PCMPEQB, PCMPEQW, PCMPEQD, PSHUFD,
+    ADDPS, SUBPS, MULPS,
+
+    // Misceláneas
+    NOP, HLT, CDQ, LEAVE,
+
+    TOTAL
+};
+
+constexpr bool es_directiva(Mnemonico m) {
+    return m >= Mnemonico::SECTION && m <= Mnemonico::INCBIN;
+}
+
+// Directivas que emiten o reservan datos (admiten una etiqueta sin ':' delante)
+constexpr bool es_directiva_datos(Mnemonico m) {
+    return m >= Mnemonico::DB && m <= Mnemonico::INCBIN;
+}
+
+constexpr bool es_salto_condicional(Mnemonico m) {
+    return m >= Mnemonico::JO && m <= Mnemonico::JG;
+}
+
+constexpr bool es_vectorial(Mnemonico m) {
+    return m >= Mnemonico::MOVDQA && m <= Mnemonico::MULPS;
+}
+
+// Clases de mnemónicos (los grupos de arriba), para las estadísticas por clase
+enum class ClaseMnemonico : uint8_t {
+    DIRECTIVA, TRANSFERENCIA, ARITMETICA, CONTROL, VECTORIAL, MISCELANEA,
+    TOTAL
+};
+
+constexpr ClaseMnemonico clase_mnemonico(Mnemonico m) {
+    return es_directiva(m)                                   ? ClaseMnemonico::DIRECTIVA
+         : (m >= Mnemonico::MOV && m <= Mnemonico::XCHG)     ? ClaseMnemonico::TRANSFERENCIA
+         : (m >= Mnemonico::ADD && m <= Mnemonico::SAR)      ? ClaseMnemonico::ARITMETICA
+         : (m >= Mnemonico::JMP && m <= Mnemonico::JG)       ? ClaseMnemonico::CONTROL
+         : es_vectorial(m)                                   ? ClaseMnemonico::VECTORIAL
+         :                                                     ClaseMnemonico::MISCELANEA;
+}
+
+// Efecto sobre EFLAGS, para saber en la optimización de mirilla si las
+// banderas de una instrucción se llegan a leer
+enum class EfectoBanderas : uint8_t {
+    NINGUNO,    // Ni las lee ni las escribe
+    ESCRIBE,    // Las redefine todas sin leerlas (o las deja indefinidas)
+    PARCIAL,    // Redefine sólo algunas (INC/DEC conservan CF; desplazamientos con contador 0)
+    LEE,        // Las lee (ADC, SBB, Jcc)
+    BARRERA     // Transfiere el control: no se sabe quién las lee después
+};
+
+constexpr EfectoBanderas efecto_banderas(Mnemonico m) {
+    switch (m) {
+        case Mnemonico::MOV: case Mnemonico::LEA: case Mnemonico::PUSH: case Mnemonico::POP:
+        case Mnemonico::XCHG: case Mnemonico::NOT: case Mnemonico::NOP: case Mnemonico::CDQ:
+        case Mnemonico::LEAVE:
+            return EfectoBanderas::NINGUNO;
+        case Mnemonico::ADD: case Mnemonico::OR: case Mnemonico::AND: case Mnemonico::SUB:
+        case Mnemonico::XOR: case Mnemonico::CMP: case Mnemonico::TEST: case Mnemonico::NEG:
+        case Mnemonico::MUL: case Mnemonico::IMUL: case Mnemonico::DIV: case Mnemonico::IDIV:
+            return EfectoBanderas::ESCRIBE;
+        case Mnemonico::INC: case Mnemonico::DEC:
+        case Mnemonico::ROL: case Mnemonico::ROR: case Mnemonico::SHL: case Mnemonico::SHR:
+        case Mnemonico::SAR:
+            return EfectoBanderas::PARCIAL;
+        case Mnemonico::ADC: case Mnemonico::SBB:
+            return EfectoBanderas::LEE;
+        default:
+            if (es_vectorial(m)) return EfectoBanderas::NINGUNO;
+            return es_salto_condicional(m) ? EfectoBanderas::LEE : EfectoBanderas::BARRERA;
+    }
+}
+
+// --- NOMBRES Y ALIAS ---
+struct NombreMnemonico {
+    const char* nombre;
+    Mnemonico id;
+};
+
+constexpr NombreMnemonico NOMBRES_MNEMONICOS[] = {
+    {"SECTION", Mnemonico::SECTION}, {"SEGMENT", Mnemonico::SECTION},
+    {"GLOBAL", Mnemonico::GLOBAL},   {"EXTERN", Mnemonico::EXTERN},
+    {"%INCLUDE", Mnemonico::INCLUDE}, {"ALIGN", Mnemonico::ALIGN},
+    {"DB", Mnemonico::DB},           {"DW", Mnemonico::DW},     {"DD", Mnemonico::DD},
+    {"TIMES", Mnemonico::TIMES},     {"RESB", Mnemonico::RESB}, {"RESW", Mnemonico::RESW},
+    {"RESD", Mnemonico::RESD},       {"INCBIN", Mnemonico::INCBIN},
+
+    {"MOV", Mnemonico::MOV},   {"LEA", Mnemonico::LEA},   {"PUSH", Mnemonico::PUSH},
+    {"POP", Mnemonico::POP},   {"XCHG", Mnemonico::XCHG},
+
+    {"ADD", Mnemonico::ADD},   {"OR", Mnemonico::OR},     {"ADC", Mnemonico::ADC},
+    {"SBB", Mnemonico::SBB},   {"AND", Mnemonico::AND},   {"SUB", Mnemonico::SUB},
+    {"XOR", Mnemonico::XOR},   {"CMP", Mnemonico::CMP},   {"TEST", Mnemonico::TEST},
+    {"INC", Mnemonico::INC},   {"DEC", Mnemonico::DEC},   {"NOT", Mnemonico::NOT},
+    {"NEG", Mnemonico::NEG},   {"MUL", Mnemonico::MUL},   {"IMUL", Mnemonico::IMUL},
+    {"DIV", Mnemonico::DIV},   {"IDIV", Mnemonico::IDIV},
+    {"ROL", Mnemonico::ROL},   {"ROR", Mnemonico::ROR},   {"SHL", Mnemonico::SHL},
+    {"SAL", Mnemonico::SHL},   {"SHR", Mnemonico::SHR},   {"SAR", Mnemonico::SAR},
+
+    {"JMP", Mnemonico::JMP},   {"CALL", Mnemonico::CALL}, {"RET", Mnemonico::RET},
+    {"INT", Mnemonico::INT},
+
+    {"JO", Mnemonico::JO},     {"JNO", Mnemonico::JNO},
+    {"JB", Mnemonico::JB},     {"JC", Mnemonico::JB},     {"JNAE", Mnemonico::JB},
+    {"JAE", Mnemonico::JAE},   {"JNB", Mnemonico::JAE},   {"JNC", Mnemonico::JAE},
+    {"JE", Mnemonico::JE},     {"JZ", Mnemonico::JE},
+    {"JNE", Mnemonico::JNE},   {"JNZ", Mnemonico::JNE},
+    {"JBE", Mnemonico::JBE},   {"JNA", Mnemonico::JBE},
+    {"JA", Mnemonico::JA},     {"JNBE", Mnemonico::JA},
+    {"JS", Mnemonico::JS},     {"JNS", Mnemonico::JNS},
+    {"JP", Mnemonico::JP},     {"JPE", Mnemonico::JP},
+    {"JNP", Mnemonico::JNP},   {"JPO", Mnemonico::JNP},
+    {"JL", Mnemonico::JL},     {"JNGE", Mnemonico::JL},
+    {"JGE", Mnemonico::JGE},   {"JNL", Mnemonico::JGE},
+    {"JLE", Mnemonico::JLE},   {"JNG", Mnemonico::JLE},
+    {"JG", Mnemonico::JG},     {"JNLE", Mnemonico::JG},
+
+    {"MOVDQA", Mnemonico::MOVDQA},   {"MOVDQU", Mnemonico::MOVDQU},
+    {"MOVAPS", Mnemonico::MOVAPS},   {"MOVUPS", Mnemonico::MOVUPS},
+    {"PADDB", Mnemonico::PADDB},     {"PADDW", Mnemonico::PADDW},
+    {"PADDD", Mnemonico::PADDD},     {"PADDQ", Mnemonico::PADDQ},
+    {"PSUBB", Mnemonico::PSUBB},     {"PSUBW", Mnemonico::PSUBW},
+    {"PSUBD", Mnemonico::PSUBD},     {"PSUBQ", Mnemonico::PSUBQ},
+    {"PMULLW", Mnemonico::PMULLW},   {"PMULLD", Mnemonico::PMULLD},
+    {"PAND", Mnemonico::PAND},       {"PANDN", Mnemonico::PANDN},
+    {"POR", Mnemonico::POR},         {"PXOR", Mnemonico::PXOR},
+    {"PCMPEQB", Mnemonico::PCMPEQB}, {"PCMPEQW", Mnemonico::PCMPEQW},
+    {"PCMPEQD", Mnemonico::PCMPEQD}, {"PSHUFD", Mnemonico::PSHUFD},
+    {"ADDPS", Mnemonico::ADDPS},     {"SUBPS", Mnemonico::SUBPS},
+    {"MULPS", Mnemonico::MULPS},
+
+    {"NOP", Mnemonico::NOP},   {"HLT", Mnemonico::HLT},   {"CDQ", Mnemonico::CDQ},
+    {"LEAVE", Mnemonico::LEAVE},
+};
+
+constexpr size_t TOTAL_NOMBRES = sizeof(NOMBRES_MNEMONICOS) / sizeof(NOMBRES_MNEMONICOS[0]);
+
+// Nombre canónico (el primero de la tabla; los alias van detrás)
+constexpr const char* nombre_mnemonico(Mnemonico m) {
+    for (size_t i = 0; i < TOTAL_NOMBRES; ++i) {
+        if (NOMBRES_MNEMONICOS[i].id == m) return NOMBRES_MNEMONICOS[i].nombre;
+    }
+    return "?";
+}
+
+// -----------------------------------------------------------------------------
+// Hash perfecto de mnemónicos (calculado en tiempo de compilación)
+// -----------------------------------------------------------------------------
+// El hash ignora mayúsculas/minúsculas (bit 0x20) y se busca en compilación una
+// semilla sin colisiones, de modo que una búsqueda cuesta un hash y una comparación.
+
+constexpr size_t BITS_HASH_MNEMONICOS = 11;
+constexpr size_t TAM_HASH_MNEMONICOS = size_t(1) << BITS_HASH_MNEMONICOS;
+
+constexpr size_t longitud_cadena(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') ++n;
+    return n;
+}
+
+constexpr uint32_t hash_mnemonico(const char* s, size_t n, uint32_t semilla) {
+    uint32_t h = semilla;
+    for (size_t i = 0; i < n; ++i) {
+        h = (h ^ (static_cast<uint8_t>(s[i]) & 0xDF)) * 16777619u;
+    }
+    return (h ^ (h >> 15)) & (TAM_HASH_MNEMONICOS - 1);
+}
+
+constexpr bool semilla_sin_colisiones(uint32_t semilla) {
+    bool ocupado[TAM_HASH_MNEMONICOS] = {};
+    for (size_t i = 0; i < TOTAL_NOMBRES; ++i) {
+        const char* nombre = NOMBRES_MNEMONICOS[i].nombre;
+        uint32_t h = hash_mnemonico(nombre, longitud_cadena(nombre), semilla);
+        if (ocupado[h]) return false;
+        ocupado[h] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t buscar_semilla_perfecta() {
+    for (uint32_t semilla = 2166136261u; semilla < 2166136261u + 100000u; ++semilla) {
+        if (semilla_sin_colisiones(semilla)) return semilla;
+    }
+    return 0;
+}
+
+constexpr uint32_t SEMILLA_MNEMONICOS = buscar_semilla_perfecta();
+static_assert(SEMILLA_MNEMONICOS != 0, "No se encontró una semilla de hash perfecto para los mnemónicos");
+
+struct TablaHashMnemonicos {
+    uint8_t ranura[TAM_HASH_MNEMONICOS]; // Índice+1 en NOMBRES_MNEMONICOS (0 = vacío)
+};
+
+constexpr TablaHashMnemonicos construir_tabla_hash() {
+    TablaHashMnemonicos t = {};
+    for (size_t i = 0; i < TOTAL_NOMBRES; ++i) {
+        const char* nombre = NOMBRES_MNEMONICOS[i].nombre;
+        t.ranura[hash_mnemonico(nombre, longitud_cadena(nombre), SEMILLA_MNEMONICOS)] =
+            static_cast<uint8_t>(i + 1);
+    }
+    return t;
+}
+
+constexpr TablaHashMnemonicos TABLA_HASH_MNEMONICOS = construir_tabla_hash();
+static_assert(TOTAL_NOMBRES < 255, "La tabla hash guarda índices de 8 bits");
+
+// Devuelve el identificador del mnemónico (sin distinguir mayúsculas) o DESCONOCIDO.
+constexpr Mnemonico buscar_mnemonico(const char* s, size_t n) {
+    uint8_t r = TABLA_HASH_MNEMONICOS.ranura[hash_mnemonico(s, n, SEMILLA_MNEMONICOS)];
+    if (r == 0) return Mnemonico::DESCONOCIDO;
+
+    const char* nombre = NOMBRES_MNEMONICOS[r - 1].nombre;
+    size_t i = 0;
+    for (; i < n; ++i) {
+        char c = s[i];
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        if (nombre[i] != c) return Mnemonico::DESCONOCIDO;
+    }
+    return nombre[i] == '\0' ? NOMBRES_MNEMONICOS[r - 1].id : Mnemonico::DESCONOCIDO;
+}
+
+static_assert(buscar_mnemonico("jnz", 3) == Mnemonico::JNE, "Alias de mnemónico mal resuelto");
+static_assert(buscar_mnemonico("MOVX", 4) == Mnemonico::DESCONOCIDO, "Mnemónico inexistente aceptado");
+
+// -----------------------------------------------------------------------------
+// Formas de codificación
+// -----------------------------------------------------------------------------
+
+// Clase de operando que acepta una forma de instrucción
+enum class FormaOperando : uint8_t {
+    NINGUNO,
+    R8, R32,        // Registro
+    AL, CL, EAX,    // Registro fijo
+    RM8, RM32,      // Registro o memoria
+    MEM,            // Sólo memoria (LEA)
+    MOFFS8,         // Memoria sólo con dirección, sin base ni índice (MOV AL, [X])
+    MOFFS32,        // Ídem de 32 bits (MOV EAX, [X])
+    IMM8,           // Inmediato con signo de 8 bits (se extiende a 32)
+    IMM8U,          // Inmediato de 8 bits (-128..255)
+    IMM16,          // Inmediato de 16 bits
+    IMM32,          // Inmediato de 32 bits o dirección de etiqueta
+    UNO,            // La constante 1 (desplazamientos D1 /n)
+    REL,            // Destino de salto (etiqueta)
+    XMM,            // Registro XMM0..XMM7
+    XMMM128         // Registro XMM o memoria de 128 bits
+};
+
+// Cómo se construyen los bytes de la instrucción a partir del opcode
+enum class Codificacion : uint8_t {
+    SOLO_OPCODE,    // opcode [inmediatos]
+    REG_EN_OPCODE,  // opcode + rd [inmediatos]
+    MODRM,          // opcode ModR/M [SIB] [desplazamiento] [inmediatos]
+    DIRECCION,      // opcode moffs32 (MOV con el acumulador)
+    RELATIVO        // opcode rel32
+};
+
+struct FormaInstruccion {
+    Mnemonico mnem;
+    FormaOperando op[3];
+    bool escape_0f;        // El opcode va precedido de 0F
+    uint8_t opcode;
+    int8_t extension;      // /digit en el campo reg de ModR/M; -1 si es /r
+    Codificacion codificacion;
+    uint8_t prefijo = 0;            // Prefijo obligatorio (66, F2, F3) delante de 0F; 0 si no hay
+    uint8_t escape_secundario = 0;  // Segundo byte de escape tras 0F (38 en SSE4.1); 0 si no hay
+};
+
+// Las formas de cada mnemónico van contiguas y en el orden en que se prueban:
+// la primera que encaja con los operandos es la que se emite.
+#define F_ FormaOperando
+#define C_ Codificacion
+#define M_ Mnemonico
+#define GRUPO_ALU(MN, EXT)                                                            \
+    {M_::MN, {F_::RM32, F_::R32,   F_::NINGUNO}, false, (EXT) * 8 + 1, -1,  C_::MODRM},  \
+    {M_::MN, {F_::R32,  F_::RM32,  F_::NINGUNO}, false, (EXT) * 8 + 3, -1,  C_::MODRM},  \
+    {M_::MN, {F_::RM8,  F_::R8,    F_::NINGUNO}, false, (EXT) * 8 + 0, -1,  C_::MODRM},  \
+    {M_::MN, {F_::R8,   F_::RM8,   F_::NINGUNO}, false, (EXT) * 8 + 2, -1,  C_::MODRM},  \
+    {M_::MN, {F_::RM32, F_::IMM8,  F_::NINGUNO}, false, 0x83,          EXT, C_::MODRM},  \
+    {M_::MN, {F_::EAX,  F_::IMM32, F_::NINGUNO}, false, (EXT) * 8 + 5, -1,  C_::SOLO_OPCODE}, \
+    {M_::MN, {F_::RM32, F_::IMM32, F_::NINGUNO}, false, 0x81,          EXT, C_::MODRM},  \
+    {M_::MN, {F_::AL,   F_::IMM8U, F_::NINGUNO}, false, (EXT) * 8 + 4, -1,  C_::SOLO_OPCODE}, \
+    {M_::MN, {F_::RM8,  F_::IMM8U, F_::NINGUNO}, false, 0x80,          EXT, C_::MODRM}
+#define GRUPO_UNARIO(MN, EXT)                                                         \
+    {M_::MN, {F_::RM32, F_::NINGUNO, F_::NINGUNO}, false, 0xF7, EXT, C_::MODRM},         \
+    {M_::MN, {F_::RM8,  F_::NINGUNO, F_::NINGUNO}, false, 0xF6, EXT, C_::MODRM}
+#define GRUPO_DESPLAZAMIENTO(MN, EXT)                                                 \
+    {M_::MN, {F_::RM32, F_::UNO,   F_::NINGUNO}, false, 0xD1, EXT, C_::MODRM},           \
+    {M_::MN, {F_::RM32, F_::CL,    F_::NINGUNO}, false, 0xD3, EXT, C_::MODRM},           \
+    {M_::MN, {F_::RM32, F_::IMM8U, F_::NINGUNO}, false, 0xC1, EXT, C_::MODRM}
+#define SALTO_CONDICIONAL(MN, CC)                                                     \
+    {M_::MN, {F_::REL, F_::NINGUNO, F_::NINGUNO}, true, 0x80 + (CC), -1, C_::RELATIVO}
+#define MOVIMIENTO_SSE(MN, PREFIJO, CARGA, ALMACEN)                                      \
+    {M_::MN, {F_::XMM,     F_::XMMM128, F_::NINGUNO}, true, CARGA,   -1, C_::MODRM, PREFIJO}, \
+    {M_::MN, {F_::XMMM128, F_::XMM,     F_::NINGUNO}, true, ALMACEN, -1, C_::MODRM, PREFIJO}
+#define OPERACION_SSE(MN, PREFIJO, OP)                                                   \
+    {M_::MN, {F_::XMM, F_::XMMM128, F_::NINGUNO}, true, OP, -1, C_::MODRM, PREFIJO}
+
+constexpr FormaInstruccion TABLA_FORMAS[] = {
+    // MOV (las formas del acumulador con dirección directa ahorran el ModR/M)
+    {M_::MOV, {F_::EAX,     F_::MOFFS32, F_::NINGUNO}, false, 0xA1, -1, C_::DIRECCION},
+    {M_::MOV, {F_::MOFFS32, F_::EAX,     F_::NINGUNO}, false, 0xA3, -1, C_::DIRECCION},
+    {M_::MOV, {F_::AL,      F_::MOFFS8,  F_::NINGUNO}, false, 0xA0, -1, C_::DIRECCION},
+    {M_::MOV, {F_::MOFFS8,  F_::AL,      F_::NINGUNO}, false, 0xA2, -1, C_::DIRECCION},
+    {M_::MOV, {F_::RM32, F_::R32,   F_::NINGUNO}, false, 0x89, -1, C_::MODRM},
+    {M_::MOV, {F_::R32,  F_::RM32,  F_::NINGUNO}, false, 0x8B, -1, C_::MODRM},
+    {M_::MOV, {F_::RM8,  F_::R8,    F_::NINGUNO}, false, 0x88, -1, C_::MODRM},
+    {M_::MOV, {F_::R8,   F_::RM8,   F_::NINGUNO}, false, 0x8A, -1, C_::MODRM},
+    {M_::MOV, {F_::R32,  F_::IMM32, F_::NINGUNO}, false, 0xB8, -1, C_::REG_EN_OPCODE},
+    {M_::MOV, {F_::R8,   F_::IMM8U, F_::NINGUNO}, false, 0xB0, -1, C_::REG_EN_OPCODE},
+    {M_::MOV, {F_::RM32, F_::IMM32, F_::NINGUNO}, false, 0xC7,  0, C_::MODRM},
+    {M_::MOV, {F_::RM8,  F_::IMM8U, F_::NINGUNO}, false, 0xC6,  0, C_::MODRM},
+
+    // LEA
+    {M_::LEA, {F_::R32, F_::MEM, F_::NINGUNO}, false, 0x8D, -1, C_::MODRM},
+
+    // PUSH / POP
+    {M_::PUSH, {F_::R32,   F_::NINGUNO, F_::NINGUNO}, false, 0x50, -1, C_::REG_EN_OPCODE},
+    {M_::PUSH, {F_::IMM8,  F_::NINGUNO, F_::NINGUNO}, false, 0x6A, -1, C_::SOLO_OPCODE},
+    {M_::PUSH, {F_::IMM32, F_::NINGUNO, F_::NINGUNO}, false, 0x68, -1, C_::SOLO_OPCODE},
+    {M_::PUSH, {F_::RM32,  F_::NINGUNO, F_::NINGUNO}, false, 0xFF,  6, C_::MODRM},
+    {M_::POP,  {F_::R32,   F_::NINGUNO, F_::NINGUNO}, false, 0x58, -1, C_::REG_EN_OPCODE},
+    {M_::POP,  {F_::RM32,  F_::NINGUNO, F_::NINGUNO}, false, 0x8F,  0, C_::MODRM},
+
+    // XCHG (con EAX: 90+rd, un solo byte)
+    {M_::XCHG, {F_::EAX,  F_::R32,  F_::NINGUNO}, false, 0x90, -1, C_::REG_EN_OPCODE},
+    {M_::XCHG, {F_::R32,  F_::EAX,  F_::NINGUNO}, false, 0x90, -1, C_::REG_EN_OPCODE},
+    {M_::XCHG, {F_::RM32, F_::R32,  F_::NINGUNO}, false, 0x87, -1, C_::MODRM},
+    {M_::XCHG, {F_::R32,  F_::RM32, F_::NINGUNO}, false, 0x87, -1, C_::MODRM},
+
+    // Grupo ALU: ADD /0, OR /1, ADC /2, SBB /3, AND /4, SUB /5, XOR /6, CMP /7
+    GRUPO_ALU(ADD, 0), GRUPO_ALU(OR, 1),  GRUPO_ALU(ADC, 2), GRUPO_ALU(SBB, 3),
+    GRUPO_ALU(AND, 4), GRUPO_ALU(SUB, 5), GRUPO_ALU(XOR, 6), GRUPO_ALU(CMP, 7),
+
+    // TEST
+    {M_::TEST, {F_::RM32, F_::R32,   F_::NINGUNO}, false, 0x85, -1, C_::MODRM},
+    {M_::TEST, {F_::RM8,  F_::R8,    F_::NINGUNO}, false, 0x84, -1, C_::MODRM},
+    {M_::TEST, {F_::EAX,  F_::IMM32, F_::NINGUNO}, false, 0xA9, -1, C_::SOLO_OPCODE},
+    {M_::TEST, {F_::AL,   F_::IMM8U, F_::NINGUNO}, false, 0xA8, -1, C_::SOLO_OPCODE},
+    {M_::TEST, {F_::RM32, F_::IMM32, F_::NINGUNO}, false, 0xF7,  0, C_::MODRM},
+    {M_::TEST, {F_::RM8,  F_::IMM8U, F_::NINGUNO}, false, 0xF6,  0, C_::MODRM},
+
+    // INC / DEC
+    {M_::INC, {F_::R32,  F_::NINGUNO, F_::NINGUNO}, false, 0x40, -1, C_::REG_EN_OPCODE},
+    {M_::INC, {F_::RM32, F_::NINGUNO, F_::NINGUNO}, false, 0xFF,  0, C_::MODRM},
+    {M_::INC, {F_::RM8,  F_::NINGUNO, F_::NINGUNO}, false, 0xFE,  0, C_::MODRM},
+    {M_::DEC, {F_::R32,  F_::NINGUNO, F_::NINGUNO}, false, 0x48, -1, C_::REG_EN_OPCODE},
+    {M_::DEC, {F_::RM32, F_::NINGUNO, F_::NINGUNO}, false, 0xFF,  1, C_::MODRM},
+    {M_::DEC, {F_::RM8,  F_::NINGUNO, F_::NINGUNO}, false, 0xFE,  1, C_::MODRM},
+
+    // Grupo F6/F7: NOT /2, NEG /3, MUL /4, IMUL /5, DIV /6, IDIV /7
+    GRUPO_UNARIO(NOT, 2), GRUPO_UNARIO(NEG, 3), GRUPO_UNARIO(MUL, 4),
+    GRUPO_UNARIO(IMUL, 5),
+    {M_::IMUL, {F_::R32, F_::RM32, F_::NINGUNO}, true,  0xAF, -1, C_::MODRM},
+    {M_::IMUL, {F_::R32, F_::RM32, F_::IMM8},    false, 0x6B, -1, C_::MODRM},
+    {M_::IMUL, {F_::R32, F_::RM32, F_::IMM32},   false, 0x69, -1, C_::MODRM},
+    GRUPO_UNARIO(DIV, 6), GRUPO_UNARIO(IDIV, 7),
+
+    // Rotaciones y desplazamientos: ROL /0, ROR /1, SHL /4, SHR /5, SAR /7
+    GRUPO_DESPLAZAMIENTO(ROL, 0), GRUPO_DESPLAZAMIENTO(ROR, 1),
+    GRUPO_DESPLAZAMIENTO(SHL, 4), GRUPO_DESPLAZAMIENTO(SHR, 5),
+    GRUPO_DESPLAZAMIENTO(SAR, 7),
+
+    // Control de flujo
+    {M_::JMP,  {F_::REL,   F_::NINGUNO, F_::NINGUNO}, false, 0xE9, -1, C_::RELATIVO},
+    {M_::JMP,  {F_::RM32,  F_::NINGUNO, F_::NINGUNO}, false, 0xFF,  4, C_::MODRM},
+    {M_::CALL, {F_::REL,   F_::NINGUNO, F_::NINGUNO}, false, 0xE8, -1, C_::RELATIVO},
+    {M_::CALL, {F_::RM32,  F_::NINGUNO, F_::NINGUNO}, false, 0xFF,  2, C_::MODRM},
+    {M_::RET,  {F_::NINGUNO, F_::NINGUNO, F_::NINGUNO}, false, 0xC3, -1, C_::SOLO_OPCODE},
+    {M_::RET,  {F_::IMM16, F_::NINGUNO, F_::NINGUNO}, false, 0xC2, -1, C_::SOLO_OPCODE},
+    {M_::INT,  {F_::IMM8U, F_::NINGUNO, F_::NINGUNO}, false, 0xCD, -1, C_::SOLO_OPCODE},
+
+    SALTO_CONDICIONAL(JO, 0x0),  SALTO_CONDICIONAL(JNO, 0x1),
+    SALTO_CONDICIONAL(JB, 0x2),  SALTO_CONDICIONAL(JAE, 0x3),
+    SALTO_CONDICIONAL(JE, 0x4),  SALTO_CONDICIONAL(JNE, 0x5),
+    SALTO_CONDICIONAL(JBE, 0x6), SALTO_CONDICIONAL(JA, 0x7),
+    SALTO_CONDICIONAL(JS, 0x8),  SALTO_CONDICIONAL(JNS, 0x9),
+    SALTO_CONDICIONAL(JP, 0xA),  SALTO_CONDICIONAL(JNP, 0xB),
+    SALTO_CONDICIONAL(JL, 0xC),  SALTO_CONDICIONAL(JGE, 0xD),
+    SALTO_CONDICIONAL(JLE, 0xE), SALTO_CONDICIONAL(JG, 0xF),
+
+    // Vectoriales: prefijo obligatorio (66 enteros de 128 bits, F3 sin
+    // alinear, ninguno en los de coma flotante simple), 0F y opcode /r
+    MOVIMIENTO_SSE(MOVDQA, 0x66, 0x6F, 0x7F), MOVIMIENTO_SSE(MOVDQU, 0xF3, 0x6F, 0x7F),
+    MOVIMIENTO_SSE(MOVAPS, 0x00, 0x28, 0x29), MOVIMIENTO_SSE(MOVUPS, 0x00, 0x10, 0x11),
+    OPERACION_SSE(PADDB, 0x66, 0xFC),   OPERACION_SSE(PADDW, 0x66, 0xFD),
+    OPERACION_SSE(PADDD, 0x66, 0xFE),   OPERACION_SSE(PADDQ, 0x66, 0xD4),
+    OPERACION_SSE(PSUBB, 0x66, 0xF8),   OPERACION_SSE(PSUBW, 0x66, 0xF9),
+    OPERACION_SSE(PSUBD, 0x66, 0xFA),   OPERACION_SSE(PSUBQ, 0x66, 0xFB),
+    OPERACION_SSE(PMULLW, 0x66, 0xD5),
+    {M_::PMULLD, {F_::XMM, F_::XMMM128, F_::NINGUNO}, true, 0x40, -1, C_::MODRM, 0x66, 0x38},
+    OPERACION_SSE(PAND, 0x66, 0xDB),    OPERACION_SSE(PANDN, 0x66, 0xDF),
+    OPERACION_SSE(POR, 0x66, 0xEB),     OPERACION_SSE(PXOR, 0x66, 0xEF),
+    OPERACION_SSE(PCMPEQB, 0x66, 0x74), OPERACION_SSE(PCMPEQW, 0x66, 0x75),
+    OPERACION_SSE(PCMPEQD, 0x66, 0x76),
+    {M_::PSHUFD, {F_::XMM, F_::XMMM128, F_::IMM8U}, true, 0x70, -1, C_::MODRM, 0x66},
+    OPERACION_SSE(ADDPS, 0x00, 0x58),   OPERACION_SSE(SUBPS, 0x00, 0x5C),
+    OPERACION_SSE(MULPS, 0x00, 0x59),
+
+    // Misceláneas
+    {M_::NOP,   {F_::NINGUNO, F_::NINGUNO, F_::NINGUNO}, false, 0x90, -1, C_::SOLO_OPCODE},
+    {M_::HLT,   {F_::NINGUNO, F_::NINGUNO, F_::NINGUNO}, false, 0xF4, -1, C_::SOLO_OPCODE},
+    {M_::CDQ,   {F_::NINGUNO, F_::NINGUNO, F_::NINGUNO}, false, 0x99, -1, C_::SOLO_OPCODE},
+    {M_::LEAVE, {F_::NINGUNO, F_::NINGUNO, F_::NINGUNO}, false, 0xC9, -1, C_::SOLO_OPCODE},
+};
+
+#undef OPERACION_SSE
+#undef MOVIMIENTO_SSE
+#undef SALTO_CONDICIONAL
+#undef GRUPO_DESPLAZAMIENTO
+#undef GRUPO_UNARIO
+#undef GRUPO_ALU
+#undef M_
+#undef C_
+#undef F_
+
+constexpr size_t TOTAL_FORMAS = sizeof(TABLA_FORMAS) / sizeof(TABLA_FORMAS[0]);
+
+// Rango [inicio, inicio + cantidad) de TABLA_FORMAS para cada mnemónico
+struct RangoFormas {
+    uint16_t inicio;
+    uint16_t cantidad;
+};
+
+struct IndiceFormas {
+    RangoFormas rango[static_cast<size_t>(Mnemonico::TOTAL)];
+};
+
+constexpr IndiceFormas construir_indice_formas() {
+    IndiceFormas indice = {};
+    for (size_t i = 0; i < TOTAL_FORMAS; ++i) {
+        RangoFormas& r = indice.rango[static_cast<size_t>(TABLA_FORMAS[i].mnem)];
+        if (r.cantidad == 0) r.inicio = static_cast<uint16_t>(i);
+        ++r.cantidad;
+    }
+    return indice;
+}
+
+constexpr IndiceFormas INDICE_FORMAS = construir_indice_formas();
+
+constexpr bool formas_contiguas() {
+    for (size_t m = 0; m < static_cast<size_t>(Mnemonico::TOTAL); ++m) {
+        const RangoFormas& r = INDICE_FORMAS.rango[m];
+        for (size_t i = r.inicio; i < size_t(r.inicio) + r.cantidad; ++i) {
+            if (static_cast<size_t>(TABLA_FORMAS[i].mnem) != m) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(formas_contiguas(), "Las formas de cada mnemónico deben ir contiguas en TABLA_FORMAS");
+
+#endif // TABLA_OPCODES_HPP
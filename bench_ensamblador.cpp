@@ -0,0 +1,284 @@
+#include "EnsambladorIA32.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// 📌 Parámetros de la carga sintética
+// -----------------------------------------------------------------------------
+
+struct ConfigCarga {
+    size_t lineas = 0;
+    unsigned densidad_etiquetas = 10;   // Etiquetas por cada 100 líneas
+    unsigned porcentaje_adelante = 50;  // % de saltos hacia etiquetas posteriores
+    unsigned porcentaje_lejanos = 5;    // % de saltos que necesitan rel32
+    uint32_t semilla = 12345;
+};
+
+struct Medicion {
+    size_t lineas;
+    size_t bytes_fuente;
+    size_t bytes_codigo;
+    double t_escanear;     // Sólo el escáner de líneas, sobre el texto en memoria
+    double t_ensamblar;
+    double t_resolver;
+    double t_generar_hex;
+    long rss_pico_kb;
+};
+
+// -----------------------------------------------------------------------------
+// 🏭 Generador
+// -----------------------------------------------------------------------------
+
+// Genera un programa con la mezcla de instrucciones de programa.asm: cargas y
+// almacenamientos [etiqueta], inmediatos, CMP/Jcc, IMUL, DEC, JMP, CALL e INT.
+// Todas las etiquetas referenciadas quedan definidas.
+static string generar_programa(const ConfigCarga& cfg) {
+    static const char* const REGS[] = {"EAX", "ECX", "EDX", "EBX", "ESI", "EDI"};
+    static const char* const CONDICIONES[] = {"JE", "JNE", "JL", "JLE", "JG", "JGE", "JB", "JA"};
+
+    mt19937 rng(cfg.semilla);
+    auto azar = [&rng](uint32_t n) { return static_cast<uint32_t>(rng() % n); };
+
+    string texto;
+    texto.reserve(cfg.lineas * 20);
+    texto += "SECTION .TEXT\nGLOBAL _START\n_START:\n";
+
+    size_t etiquetas = 0;          // Etiquetas ya emitidas (L0 .. L<etiquetas-1>)
+    size_t max_referenciada = 0;   // Mayor índice de etiqueta usado + 1
+    char buf[64];
+
+    auto destino = [&]() -> size_t {
+        size_t distancia = azar(100) < cfg.porcentaje_lejanos ? 40 + azar(40) : 1 + azar(3);
+        size_t d;
+        if (etiquetas == 0 || azar(100) < cfg.porcentaje_adelante) d = etiquetas + distancia - 1;
+        else d = etiquetas > distancia ? etiquetas - distancia : 0;
+        max_referenciada = max(max_referenciada, d + 1);
+        return d;
+    };
+
+    for (size_t i = 0; i < cfg.lineas; ++i) {
+        if (azar(100) < cfg.densidad_etiquetas) {
+            snprintf(buf, sizeof(buf), "L%zu:\n", etiquetas++);
+            texto += buf;
+            continue;
+        }
+
+        const char* r1 = REGS[azar(6)];
+        const char* r2 = REGS[azar(6)];
+        switch (azar(20)) {
+            case 0: case 1: case 2:
+                snprintf(buf, sizeof(buf), "MOV %s, %u\n", r1, azar(100000)); break;
+            case 3: case 4:
+                snprintf(buf, sizeof(buf), "MOV %s, [L%zu]\n", r1, destino()); break;
+            case 5:
+                snprintf(buf, sizeof(buf), "MOV [L%zu], %s\n", destino(), r1); break;
+            case 6: case 7:
+                snprintf(buf, sizeof(buf), "CMP %s, %u\n", r1, azar(200)); break;
+            case 8: case 9: case 10:
+                snprintf(buf, sizeof(buf), "%s L%zu\n", CONDICIONES[azar(8)], destino()); break;
+            case 11:
+                snprintf(buf, sizeof(buf), "IMUL %s, %s\n", r1, r2); break;
+            case 12:
+                snprintf(buf, sizeof(buf), "DEC %s\n", r1); break;
+            case 13:
+                snprintf(buf, sizeof(buf), "JMP L%zu\n", destino()); break;
+            case 14:
+                snprintf(buf, sizeof(buf), "ADD %s, %s\n", r1, r2); break;
+            case 15:
+                snprintf(buf, sizeof(buf), "SUB %s, %uH\n", r1, azar(0x1000)); break;
+            case 16:
+                snprintf(buf, sizeof(buf), "CALL L%zu\n", destino()); break;
+            case 17:
+                snprintf(buf, sizeof(buf), "MOV %s, %s\n", r1, r2); break;
+            case 18:
+                snprintf(buf, sizeof(buf), "PUSH %s\n", r1); break;
+            default:
+                snprintf(buf, sizeof(buf), "INT 80H\n"); break;
+        }
+        texto += buf;
+    }
+
+    // Definir las etiquetas referenciadas hacia adelante que faltan
+    for (; etiquetas < max_referenciada; ++etiquetas) {
+        snprintf(buf, sizeof(buf), "L%zu:\n", etiquetas);
+        texto += buf;
+    }
+    texto += "RET\n";
+    return texto;
+}
+
+// -----------------------------------------------------------------------------
+// ⏱️ Medición
+// -----------------------------------------------------------------------------
+
+static double segundos_desde(chrono::steady_clock::time_point inicio) {
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+}
+
+static long rss_pico_kb() {
+    rusage uso{};
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_maxrss; // En Linux, kilobytes
+}
+
+static bool medir(const ConfigCarga& cfg, const string& dir_temporal, unsigned hilos, Medicion& m) {
+    const string fuente = dir_temporal + "/bench_" + to_string(getpid()) + ".asm";
+    const string salida = dir_temporal + "/bench_" + to_string(getpid()) + ".hex";
+
+    {
+        string texto = generar_programa(cfg);
+        m.bytes_fuente = texto.size();
+        if (!volcar_archivo(fuente, texto.data(), texto.size())) {
+            cerr << "No se pudo escribir " << fuente << endl;
+            return false;
+        }
+
+        auto inicio = chrono::steady_clock::now();
+        EscanerLineas escaner(texto);
+        LineaEscaneada linea;
+        size_t palabras = 0;
+        while (escaner.siguiente(linea)) palabras += linea.fin_token > 0;
+        m.t_escanear = segundos_desde(inicio);
+        if (palabras == 0) m.t_escanear = 0; // Que el bucle no se elimine
+    }
+    m.lineas = cfg.lineas;
+
+    {
+        EnsambladorIA32 ensamblador;
+
+        auto inicio = chrono::steady_clock::now();
+        if (hilos > 0) ensamblador.ensamblar_paralelo(fuente, hilos);
+        else ensamblador.ensamblar(fuente);
+        m.t_ensamblar = segundos_desde(inicio);
+
+        inicio = chrono::steady_clock::now();
+        ensamblador.resolver_referencias_pendientes();
+        m.t_resolver = segundos_desde(inicio);
+
+        inicio = chrono::steady_clock::now();
+        ensamblador.generar_hex(salida);
+        m.t_generar_hex = segundos_desde(inicio);
+
+        m.bytes_codigo = ensamblador.codigo().size();
+    }
+    m.rss_pico_kb = rss_pico_kb();
+
+    unlink(fuente.c_str());
+    unlink(salida.c_str());
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// 📤 Informe JSON
+// -----------------------------------------------------------------------------
+
+static void imprimir_etapa(ostream& os, const char* nombre, double t, const Medicion& m, bool ultima) {
+    const double seg = t > 0 ? t : 1e-9;
+    os << "        \"" << nombre << "\": {\"segundos\": " << t
+       << ", \"lineas_por_s\": " << static_cast<uint64_t>(m.lineas / seg)
+       << ", \"bytes_por_s\": " << static_cast<uint64_t>(m.bytes_codigo / seg) << "}"
+       << (ultima ? "\n" : ",\n");
+}
+
+static void imprimir_json(ostream& os, const ConfigCarga& cfg, unsigned hilos, const vector<Medicion>& ms) {
+    os << setprecision(6);
+    os << "{\n";
+    os << "  \"benchmark\": \"EnsambladorIA32\",\n";
+    os << "  \"configuracion\": {\"densidad_etiquetas\": " << cfg.densidad_etiquetas
+       << ", \"porcentaje_adelante\": " << cfg.porcentaje_adelante
+       << ", \"porcentaje_lejanos\": " << cfg.porcentaje_lejanos
+       << ", \"semilla\": " << cfg.semilla
+       << ", \"hilos\": " << hilos
+       << ", \"escaner\": \"" << nombre_implementacion(implementacion_escaner()) << "\"},\n";
+    os << "  \"resultados\": [\n";
+    for (size_t i = 0; i < ms.size(); ++i) {
+        const Medicion& m = ms[i];
+        os << "    {\n";
+        os << "      \"lineas\": " << m.lineas << ",\n";
+        os << "      \"bytes_fuente\": " << m.bytes_fuente << ",\n";
+        os << "      \"bytes_codigo\": " << m.bytes_codigo << ",\n";
+        os << "      \"rss_pico_kb\": " << m.rss_pico_kb << ",\n";
+        os << "      \"etapas\": {\n";
+        const double t_escanear = m.t_escanear > 0 ? m.t_escanear : 1e-9;
+        os << "        \"escanear_lineas\": {\"segundos\": " << m.t_escanear
+           << ", \"lineas_por_s\": " << static_cast<uint64_t>(m.lineas / t_escanear)
+           << ", \"bytes_fuente_por_s\": " << static_cast<uint64_t>(m.bytes_fuente / t_escanear) << "},\n";
+        imprimir_etapa(os, "ensamblar", m.t_ensamblar, m, false);
+        imprimir_etapa(os, "resolver_referencias_pendientes", m.t_resolver, m, false);
+        imprimir_etapa(os, "generar_hex", m.t_generar_hex, m, true);
+        os << "      }\n";
+        os << "    }" << (i + 1 < ms.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n";
+    os << "}\n";
+}
+
+// -----------------------------------------------------------------------------
+// 🧪 main
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    // Opciones:
+    //   -n N[,N...]   líneas por carga (por defecto 1000,10000,100000,1000000)
+    //   -e PCT        etiquetas por cada 100 líneas
+    //   -a PCT        % de referencias hacia adelante
+    //   -l PCT        % de saltos lejanos (rel32)
+    //   -s SEMILLA    semilla del generador
+    //   -j N          mide ensamblar_paralelo con N hilos
+    //   -x IMPL       escáner de líneas: escalar, sse2 o avx2 (por defecto, el
+    //                 mejor que admita la CPU)
+    //   -t DIR        directorio temporal (por defecto /tmp)
+    //   -o ARCHIVO    escribe el JSON en ARCHIVO además de en la salida estándar
+    ConfigCarga cfg;
+    vector<size_t> tamanos;
+    unsigned hilos = 0;
+    string dir_temporal = "/tmp", archivo_json;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        const char* valor = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!valor) break;
+        if (arg == "-n") {
+            for (const char* p = valor; *p;) {
+                char* fin;
+                tamanos.push_back(strtoull(p, &fin, 10));
+                p = (*fin == ',') ? fin + 1 : fin + (*fin != '\0');
+            }
+        }
+        else if (arg == "-e") cfg.densidad_etiquetas = atoi(valor);
+        else if (arg == "-a") cfg.porcentaje_adelante = atoi(valor);
+        else if (arg == "-l") cfg.porcentaje_lejanos = atoi(valor);
+        else if (arg == "-s") cfg.semilla = static_cast<uint32_t>(strtoul(valor, nullptr, 10));
+        else if (arg == "-j") hilos = atoi(valor);
+        else if (arg == "-x") {
+            if (strcmp(valor, "escalar") == 0) forzar_implementacion_escaner(ImplementacionEscaner::ESCALAR);
+            else if (strcmp(valor, "sse2") == 0) forzar_implementacion_escaner(ImplementacionEscaner::SSE2);
+            else if (strcmp(valor, "avx2") == 0) forzar_implementacion_escaner(ImplementacionEscaner::AVX2);
+        }
+        else if (arg == "-t") dir_temporal = valor;
+        else if (arg == "-o") archivo_json = valor;
+        else continue;
+        ++i;
+    }
+    if (tamanos.empty()) tamanos = {1000, 10000, 100000, 1000000};
+
+    vector<Medicion> mediciones;
+    for (size_t lineas : tamanos) {
+        cfg.lineas = lineas;
+        Medicion m{};
+        if (!medir(cfg, dir_temporal, hilos, m)) return 1;
+        mediciones.push_back(m);
+    }
+
+    imprimir_json(cout, cfg, hilos, mediciones);
+    if (!archivo_json.empty()) {
+        ofstream json(archivo_json);
+        imprimir_json(json, cfg, hilos, mediciones);
+    }
+    return 0;
+}
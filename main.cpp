@@ -0,0 +1,595 @@
+#include "EnsambladorIA32.hpp"
+#include "EnsambladoIncremental.hpp"
+#include "ModulosPrecompilados.hpp"
+#include "CacheSalidas.hpp"
+#include "SimbolosPerfilado.hpp"
+#include <cstdlib>
+#include <sys/stat.h>
+
+// Opciones que cambian el código generado: se aplican a cada ensamblador y
+// forman parte de la clave de la caché de salidas
+struct OpcionesCodigo {
+    bool optimizar = false;     // -O
+    bool flujo = false;         // -O2: además, el grafo de flujo
+    AlineacionBucles bucles;    // --alinear-bucles
+
+    template <typename Ensamblador>
+    void aplicar(Ensamblador& ensamblador) const {
+        ensamblador.activar_optimizacion(optimizar);
+        ensamblador.activar_optimizacion_flujo(flujo);
+        ensamblador.activar_alineacion_bucles(bucles);
+    }
+
+    string clave() const {
+        string opciones = flujo ? "O2" : optimizar ? "O" : "";
+        if (bucles.alineacion > 1) {
+            opciones += " A" + to_string(bucles.alineacion) + ":" + to_string(bucles.relleno_maximo);
+        }
+        return opciones;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// 👀 Modo vigilancia
+// -----------------------------------------------------------------------------
+
+static uint64_t firma_archivos(const string& archivo_entrada, const vector<DependenciaModulo>& incluidos) {
+    // Fecha de modificación y tamaño de la fuente y de sus %include; 0 si
+    // la fuente no existe
+    struct stat info{};
+    if (stat(archivo_entrada.c_str(), &info) != 0) return 0;
+    uint64_t firma = 14695981039346656037ull;
+    auto mezclar = [&firma](uint64_t v) { firma = (firma ^ v) * 1099511628211ull; };
+    for (size_t i = 0;; ++i) {
+        mezclar(static_cast<uint64_t>(info.st_mtim.tv_sec));
+        mezclar(static_cast<uint64_t>(info.st_mtim.tv_nsec));
+        mezclar(static_cast<uint64_t>(info.st_size));
+        if (i == incluidos.size()) break;
+        if (stat(incluidos[i].ruta.c_str(), &info) != 0) info = {};
+    }
+    return firma | 1;
+}
+
+static int vigilar(const string& archivo_entrada, const string& archivo_salida, const string& formato,
+                   const OpcionesCodigo& codigo) {
+    // Sondeo de la fecha de modificación de la fuente y de los archivos que
+    // incluye: en cada cambio se reensambla de forma incremental y se
+    // reescriben sólo los tramos distintos de la salida
+    EnsambladoIncremental incremental(formato);
+    codigo.aplicar(incremental);
+    uint64_t anterior = 0;
+
+    cout << "Vigilando " << archivo_entrada << " (Ctrl+C para salir)..." << endl;
+    for (;;) {
+        const uint64_t actual = firma_archivos(archivo_entrada, incremental.archivos_incluidos());
+        if (actual != 0 && actual != anterior) {
+
+            ResumenIncremental r;
+            if (incremental.actualizar(archivo_entrada, archivo_salida, r)) {
+                cout << "Ensamblado en " << fixed << setprecision(2) << r.ns / 1e6 << " ms: "
+                     << r.bloques << " bloques (" << r.reutilizados << " reutilizados, "
+                     << r.recodificados << " recodificados), "
+                     << r.bytes_escritos << " bytes escritos en " << archivo_salida << endl;
+            }
+            anterior = firma_archivos(archivo_entrada, incremental.archivos_incluidos());
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// 📂 Entradas y salidas
+// -----------------------------------------------------------------------------
+
+static bool leer_archivo_respuesta(const string& ruta, vector<string>& entradas) {
+    // Una ruta por línea; se ignoran líneas vacías y comentarios (#)
+    ifstream archivo(ruta);
+    if (!archivo) return false;
+    string linea;
+    while (getline(archivo, linea)) {
+        string_view ruta_entrada = recortar(linea);
+        if (ruta_entrada.empty() || ruta_entrada[0] == '#') continue;
+        entradas.emplace_back(ruta_entrada);
+    }
+    return true;
+}
+
+static string nombre_salida(const string& entrada, const string& formato, const string& directorio) {
+    // programa.asm -> programa.hex / .bin / .o / programa (exe)
+    size_t barra = entrada.find_last_of('/');
+    string base = barra == string::npos ? entrada : entrada.substr(barra + 1);
+    size_t punto = base.find_last_of('.');
+    if (punto != string::npos && punto > 0) base.erase(punto);
+
+    string extension = formato == "bin" ? ".bin" : formato == "elf" ? ".o" : formato == "exe" ? "" : ".hex";
+    if (!directorio.empty()) return directorio + "/" + base + extension;
+    string carpeta = barra == string::npos ? "" : entrada.substr(0, barra + 1);
+    return carpeta + base + extension;
+}
+
+static void generar_salida(EnsambladorIA32& ensamblador, const string& formato, const string& archivo_salida) {
+    if (formato == "bin") ensamblador.generar_binario(archivo_salida);
+    else if (formato == "elf") ensamblador.generar_elf(archivo_salida, false);
+    else if (formato == "exe") ensamblador.generar_elf(archivo_salida, true);
+    else ensamblador.generar_hex(archivo_salida);
+}
+
+static void mostrar_optimizaciones(ostream& os, const InformeOptimizacion& o) {
+    os << "Optimización (-O): " << o.total() << " cambios: "
+       << o.mov_cero_a_xor << " MOV r,0 -> XOR, "
+       << o.suma_uno_a_inc << " ADD/SUB r,1 -> INC/DEC, "
+       << o.movs_redundantes << " MOV redundantes, "
+       << o.saltos_al_siguiente << " saltos a la siguiente instrucción" << endl;
+    if (o.saltos_encadenados + o.saltos_invertidos + o.bloques_muertos > 0) {
+        os << "Grafo de flujo (-O2): " << o.saltos_encadenados << " saltos encadenados, "
+           << o.saltos_invertidos << " invertidos, " << o.bloques_muertos << " bloques muertos ("
+           << o.bytes_muertos << " bytes)" << endl;
+    }
+}
+
+static void mostrar_modulos(ostream& os, const CacheModulos& modulos) {
+    const uint64_t total = modulos.aciertos_memoria + modulos.aciertos_disco + modulos.ensamblados;
+    if (total == 0) return;
+    os << "Módulos incluidos: " << total << " (" << modulos.aciertos_memoria << " en memoria, "
+       << modulos.aciertos_disco << " desde disco, " << modulos.ensamblados << " ensamblados)" << endl;
+}
+
+// -----------------------------------------------------------------------------
+// 🗄️ Caché de salidas
+// -----------------------------------------------------------------------------
+
+static bool clave_de_archivo(const string& entrada, const string& formato, const string& opciones, uint64_t& clave) {
+    LectorFuente lector;
+    if (!lector.abrir(entrada)) return false;
+    clave = CacheSalidas::clave(lector.contenido(), formato, opciones);
+    return true;
+}
+
+// Escribe la salida y, si se piden, los reportes guardados para 'clave'
+static bool restaurar_salida(CacheSalidas& cache, uint64_t clave, const string& formato,
+                             const string& archivo_salida, const string* archivo_simbolos,
+                             const string* archivo_referencias, string& diagnosticos) {
+    EntradaCacheSalida entrada;
+    if (!cache.buscar(clave, entrada)) return false;
+
+    bool correcto = entrada.salida.empty() ||
+                    volcar_archivo(archivo_salida, entrada.salida.data(), entrada.salida.size(), formato == "exe");
+    if (archivo_simbolos) {
+        correcto &= volcar_archivo(*archivo_simbolos, entrada.simbolos.data(), entrada.simbolos.size());
+        correcto &= volcar_archivo(*archivo_referencias, entrada.referencias.data(), entrada.referencias.size());
+    }
+    diagnosticos = move(entrada.diagnosticos);
+    return correcto;
+}
+
+// Ensambla ya resuelto: escribe la salida y la guarda en la caché junto con
+// los reportes y los mensajes
+static void generar_y_guardar(CacheSalidas& cache, uint64_t clave, EnsambladorIA32& ensamblador,
+                              const string& formato, const string& archivo_salida,
+                              const ostringstream& mensajes) {
+    EntradaCacheSalida entrada;
+    if (ensamblador.construir_salida(formato, entrada.salida) &&
+        !volcar_archivo(archivo_salida, entrada.salida.data(), entrada.salida.size(), formato == "exe")) {
+        cerr << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return;
+    }
+    ensamblador.construir_reportes(entrada.simbolos, entrada.referencias);
+    entrada.diagnosticos = mensajes.str();
+    entrada.dependencias = ensamblador.archivos_incluidos();
+    cache.guardar(clave, entrada);
+}
+
+static void mostrar_cache(ostream& os, const CacheSalidas& cache) {
+    os << "Caché de salidas: " << cache.aciertos << " aciertos, " << cache.fallos << " fallos";
+    if (cache.expulsadas) os << ", " << cache.expulsadas << " entradas expulsadas";
+    os << endl;
+}
+
+static void escribir_estadisticas(const EstadisticasEnsamblado& e, const string& archivo_stats) {
+    if (archivo_stats.empty()) {
+        e.escribir_json(cout);
+    } else {
+        ofstream json(archivo_stats);
+        e.escribir_json(json);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// 📦 Ensamblado por lotes
+// -----------------------------------------------------------------------------
+
+struct ResultadoArchivo {
+    string salida;
+    string diagnosticos;
+    size_t errores = 0;
+    size_t advertencias = 0;
+};
+
+static void contar_diagnosticos(ResultadoArchivo& r) {
+    // Los mensajes de aviso empiezan por "Advertencia"; el resto son errores
+    size_t cursor = 0;
+    string_view linea;
+    while (siguiente_linea(r.diagnosticos, cursor, linea)) {
+        if (linea.empty()) continue;
+        if (linea.compare(0, 11, "Advertencia") == 0) ++r.advertencias;
+        else ++r.errores;
+    }
+}
+
+static int ensamblar_lote(const vector<string>& entradas, const string& formato, const string& directorio,
+                          unsigned hilos, bool reportes, const OpcionesCodigo& codigo, bool stats,
+                          const string& archivo_stats, const shared_ptr<CacheModulos>& modulos,
+                          CacheSalidas* cache) {
+    // Un EnsambladorIA32 por hilo del pool, reutilizado (reiniciar) de un
+    // archivo al siguiente; los diagnósticos de cada archivo se guardan aparte
+    // y se muestran juntos y en orden al final
+    PoolHilos pool(hilos);
+    vector<unique_ptr<EnsambladorIA32>> ensambladores(pool.total_hilos());
+    vector<EstadisticasEnsamblado> totales(pool.total_hilos());
+    vector<InformeOptimizacion> optimizaciones(pool.total_hilos());
+    vector<ResultadoArchivo> resultados(entradas.size());
+    const string opciones = codigo.clave();
+
+    for (size_t i = 0; i < entradas.size(); ++i) {
+        pool.enviar([&, i]() {
+            const int hilo = PoolHilos::hilo_actual();
+            unique_ptr<EnsambladorIA32>& ensamblador = ensambladores[hilo];
+            if (!ensamblador) {
+                ensamblador.reset(new EnsambladorIA32());
+                if (stats) ensamblador->activar_estadisticas();
+                codigo.aplicar(*ensamblador);
+                ensamblador->fijar_cache_modulos(modulos);
+            }
+
+            ResultadoArchivo& r = resultados[i];
+            r.salida = nombre_salida(entradas[i], formato, directorio);
+            const string archivo_simbolos = r.salida + ".simbolos.txt";
+            const string archivo_referencias = r.salida + ".referencias.txt";
+
+            uint64_t clave = 0;
+            const bool con_cache = cache && clave_de_archivo(entradas[i], formato, opciones, clave);
+            if (con_cache && restaurar_salida(*cache, clave, formato, r.salida, reportes ? &archivo_simbolos : nullptr,
+                                              &archivo_referencias, r.diagnosticos)) {
+                contar_diagnosticos(r);
+                return;
+            }
+
+            ostringstream mensajes;
+            ensamblador->reiniciar();
+            ensamblador->fijar_diagnosticos(mensajes);
+            ensamblador->ensamblar(entradas[i]);
+            ensamblador->resolver_referencias_pendientes();
+            if (con_cache) generar_y_guardar(*cache, clave, *ensamblador, formato, r.salida, mensajes);
+            else generar_salida(*ensamblador, formato, r.salida);
+            if (reportes) ensamblador->generar_reportes(archivo_simbolos, archivo_referencias);
+            if (stats) totales[hilo].acumular(ensamblador->consultar_estadisticas());
+            optimizaciones[hilo].acumular(ensamblador->informe_optimizacion());
+
+            r.diagnosticos = mensajes.str();
+            contar_diagnosticos(r);
+        });
+    }
+    pool.esperar();
+
+    size_t errores = 0, advertencias = 0, con_errores = 0;
+    for (size_t i = 0; i < entradas.size(); ++i) {
+        const ResultadoArchivo& r = resultados[i];
+        if (!r.diagnosticos.empty()) cerr << "== " << entradas[i] << " ==" << endl << r.diagnosticos;
+        errores += r.errores;
+        advertencias += r.advertencias;
+        con_errores += r.errores > 0;
+    }
+
+    ostream sin_salida(nullptr);
+    ostream& mensajes = (stats && archivo_stats.empty()) ? sin_salida : cout;
+    mensajes << entradas.size() << " archivos ensamblados con " << pool.total_hilos() << " hilos: "
+             << errores << " errores (" << con_errores << " archivos), "
+             << advertencias << " advertencias" << endl;
+    if (codigo.optimizar) {
+        InformeOptimizacion total;
+        for (const auto& o : optimizaciones) total.acumular(o);
+        mostrar_optimizaciones(mensajes, total);
+    }
+    mostrar_modulos(mensajes, *modulos);
+    if (cache) mostrar_cache(mensajes, *cache);
+
+    if (stats) {
+        EstadisticasEnsamblado total;
+        total.activar(true);
+        total.base_asignaciones = 0;
+        total.base_bytes_asignados = 0;
+        for (const auto& t : totales) total.acumular(t);
+        total.actualizar_asignaciones();
+        escribir_estadisticas(total, archivo_stats);
+    }
+    return con_errores > 0 ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// 🌊 Salida continua
+// -----------------------------------------------------------------------------
+
+static int ensamblar_continuo(const string& entrada, const string& archivo_salida, const string& formato,
+                              const OpcionesCodigo& codigo, bool stats, const string& archivo_stats) {
+    ostream sin_salida(nullptr);
+    ostream& mensajes = (stats && archivo_stats.empty()) ? sin_salida : cout;
+
+    EnsambladorIA32 ensamblador;
+    if (stats) ensamblador.activar_estadisticas();
+    codigo.aplicar(ensamblador);
+    ostringstream diagnosticos;
+    ensamblador.fijar_diagnosticos(diagnosticos);
+
+    mensajes << "Iniciando ensamblado continuo de " << entrada << " en " << archivo_salida << "..." << endl;
+    ResumenSalidaContinua resumen;
+    const bool escrita = ensamblador.ensamblar_continuo(entrada, archivo_salida, formato, &resumen);
+    ensamblador.generar_reportes();
+
+    mensajes << "Salida continua: " << resumen.bytes << " bytes en " << resumen.bloques << " bloques, "
+             << resumen.retenidos_maximo << " retenidos a la vez como mucho, "
+             << resumen.parches_en_memoria << " parches en memoria y "
+             << resumen.parches_en_disco << " con pwrite" << endl;
+    if (codigo.optimizar) mostrar_optimizaciones(mensajes, ensamblador.informe_optimizacion());
+    mensajes << "Proceso completado. Revise " << archivo_salida << ", simbolos.txt y referencias.txt" << endl;
+
+    ResultadoArchivo r;
+    r.diagnosticos = diagnosticos.str();
+    contar_diagnosticos(r);
+    cerr << r.diagnosticos;
+
+    if (stats) escribir_estadisticas(ensamblador.consultar_estadisticas(), archivo_stats);
+    return r.errores > 0 || !escrita ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// 🔥 Símbolos para perfilado
+// -----------------------------------------------------------------------------
+
+// "ARCHIVO[@DIRECCION]": la dirección (hexadecimal) donde se cargará el código
+static void separar_direccion(const string& opcion, string& archivo, uint64_t& direccion) {
+    const size_t arroba = opcion.rfind('@');
+    archivo = opcion.substr(0, arroba);
+    direccion = arroba == string::npos ? 0 : strtoull(opcion.c_str() + arroba + 1, nullptr, 16);
+}
+
+static bool exportar_simbolos(const EnsambladorIA32& ensamblador, const string& mapa_perf,
+                              const string& simbolos_gdb) {
+    vector<SimboloCodigo> simbolos;
+    ensamblador.simbolos_codigo(simbolos);
+    string archivo;
+    uint64_t direccion = 0;
+    bool correcto = true;
+    if (!mapa_perf.empty()) {
+        separar_direccion(mapa_perf, archivo, direccion);
+        if (!escribir_mapa_perf(simbolos, direccion, archivo)) {
+            cerr << "No se pudo escribir el mapa de perf: " << archivo << endl;
+            correcto = false;
+        }
+    }
+    if (!simbolos_gdb.empty()) {
+        // El código es de 32 bits: ELF32 i386, como el proceso que lo ejecute
+        separar_direccion(simbolos_gdb, archivo, direccion);
+        EscritorBufer salida;
+        if (salida.abrir(archivo)) {
+            construir_simbolos_elf(simbolos, direccion, ensamblador.codigo().size(), false, salida);
+        }
+        if (!salida.cerrar()) {
+            cerr << "No se pudo escribir el archivo de símbolos: " << archivo << endl;
+            correcto = false;
+        }
+    }
+    return correcto;
+}
+
+// -----------------------------------------------------------------------------
+// 🧪 main
+// -----------------------------------------------------------------------------
+
+static void mostrar_uso(const char* programa) {
+    cerr << "Uso: " << programa << " [opciones] [archivo.asm ...] [@lista]\n"
+         << "  -f FORMATO        hex (por defecto), bin, elf (objeto .o) o exe (ELF ejecutable)\n"
+         << "  -o ARCHIVO        salida (con un solo archivo de entrada)\n"
+         << "  -d DIRECTORIO     carpeta de las salidas (por defecto, junto a cada entrada)\n"
+         << "  -j N              hilos (0 = todos los núcleos); con varios archivos se\n"
+         << "                    reparten los archivos, con uno solo se divide el archivo\n"
+         << "  -O                optimización de mirilla (MOV r,0 -> XOR, ADD r,1 -> INC,\n"
+         << "                    MOV redundantes, saltos a la instrucción siguiente)\n"
+         << "  -O2               -O y además encadena saltos a JMP, invierte Jcc sobre un JMP\n"
+         << "                    y quita los bloques inalcanzables (desde el inicio, _start\n"
+         << "                    y las etiquetas GLOBAL)\n"
+         << "  --alinear-bucles=N[:M] alinea a N bytes (potencia de dos, p. ej. 16 o 32) las\n"
+         << "                    etiquetas destino de saltos hacia atrás, con NOPs de varios\n"
+         << "                    bytes y sin pasar de M bytes de relleno (N-1 por defecto)\n"
+         << "  --reportes        tablas de símbolos y referencias por archivo en lote\n"
+         << "  --stats[=ARCHIVO] informe JSON de tiempos y contadores por etapa\n"
+         << "  --analisis[=ARCHIVO] estimación estática de ciclos y presión de puertos por\n"
+         << "                    bloque básico y por bucle (un solo archivo de entrada)\n"
+         << "  --modulos=DIR     guarda en DIR los %include ya ensamblados y los reutiliza\n"
+         << "                    en siguientes ejecuciones\n"
+         << "  --cache=DIR       reutiliza la salida, los reportes y los mensajes de una\n"
+         << "                    fuente ya ensamblada con las mismas opciones\n"
+         << "  --cache-max=MB    tamaño máximo de la caché (512 por defecto); al pasarlo se\n"
+         << "                    borran las entradas usadas hace más tiempo\n"
+         << "                    (la caché no se usa con --stats, --analisis, --watch ni\n"
+         << "                    al exportar símbolos)\n"
+         << "  --mapa-perf=ARCHIVO[@DIR] añade a ARCHIVO (formato de perf: inicio, tamaño,\n"
+         << "                    nombre) las etiquetas del código cargado en DIR (hex, 0\n"
+         << "                    por defecto); un proceso que lo cargue usa /tmp/perf-<pid>.map\n"
+         << "  --simbolos-gdb=ARCHIVO[@DIR] objeto ELF con las etiquetas en DIR como\n"
+         << "                    funciones, para add-symbol-file de GDB\n"
+         << "  --watch           reensambla de forma incremental cada vez que cambia la fuente\n"
+         << "  --stream          escribe la salida (bin o hex) por bloques mientras ensambla,\n"
+         << "                    con memoria acotada para entradas enormes; los saltos hacia\n"
+         << "                    delante salen en forma larga (sin -O2, -j ni --alinear-bucles)\n"
+         << "  @lista            archivo con una ruta de entrada por línea\n"
+         << "Sin archivos de entrada se ensambla programa.asm." << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int hilos = -1;
+    string formato = "hex", archivo_salida, directorio, archivo_stats, archivo_analisis, directorio_modulos;
+    string directorio_cache, mapa_perf, simbolos_gdb;
+    uint64_t limite_cache_mb = 512;
+    bool stats = false, vigilancia = false, reportes = false, analisis = false, continuo = false;
+    OpcionesCodigo codigo;
+    vector<string> entradas;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-j") hilos = (i + 1 < argc) ? atoi(argv[++i]) : 0;
+        else if (arg.compare(0, 2, "-j") == 0) hilos = atoi(arg.c_str() + 2);
+        else if (arg == "-f" && i + 1 < argc) formato = argv[++i];
+        else if (arg == "-o" && i + 1 < argc) archivo_salida = argv[++i];
+        else if (arg == "-d" && i + 1 < argc) directorio = argv[++i];
+        else if (arg == "-O") codigo.optimizar = true;
+        else if (arg == "-O2") codigo.optimizar = codigo.flujo = true;
+        else if (arg.compare(0, 17, "--alinear-bucles=") == 0) {
+            char* fin = nullptr;
+            const unsigned long n = strtoul(arg.c_str() + 17, &fin, 10);
+            const unsigned long m = *fin == ':' ? strtoul(fin + 1, &fin, 10) : n - 1;
+            if (*fin != '\0' || n < 2 || n > 4096 || (n & (n - 1)) != 0) {
+                cerr << "--alinear-bucles necesita una potencia de dos entre 2 y 4096: " << arg.substr(17) << endl;
+                return 2;
+            }
+            codigo.bucles.alineacion = static_cast<uint16_t>(n);
+            codigo.bucles.relleno_maximo = static_cast<uint16_t>(min(m, n - 1));
+        }
+        else if (arg == "--reportes") reportes = true;
+        else if (arg == "--stats") stats = true;
+        else if (arg.compare(0, 8, "--stats=") == 0) { stats = true; archivo_stats = arg.substr(8); }
+        else if (arg == "--analisis") analisis = true;
+        else if (arg.compare(0, 11, "--analisis=") == 0) { analisis = true; archivo_analisis = arg.substr(11); }
+        else if (arg.compare(0, 10, "--modulos=") == 0) directorio_modulos = arg.substr(10);
+        else if (arg.compare(0, 8, "--cache=") == 0) directorio_cache = arg.substr(8);
+        else if (arg.compare(0, 12, "--cache-max=") == 0) limite_cache_mb = strtoull(arg.c_str() + 12, nullptr, 10);
+        else if (arg.compare(0, 12, "--mapa-perf=") == 0) mapa_perf = arg.substr(12);
+        else if (arg.compare(0, 15, "--simbolos-gdb=") == 0) simbolos_gdb = arg.substr(15);
+        else if (arg == "--watch") vigilancia = true;
+        else if (arg == "--stream") continuo = true;
+        else if (arg == "-h" || arg == "--help") { mostrar_uso(argv[0]); return 0; }
+        else if (arg[0] == '@') {
+            if (!leer_archivo_respuesta(arg.substr(1), entradas)) {
+                cerr << "No se pudo abrir la lista de archivos: " << arg.substr(1) << endl;
+                return 2;
+            }
+        }
+        else if (arg[0] == '-') { mostrar_uso(argv[0]); return 2; }
+        else entradas.push_back(arg);
+    }
+
+    if (formato != "hex" && formato != "bin" && formato != "elf" && formato != "exe") {
+        cerr << "Formato desconocido: " << formato << endl;
+        return 2;
+    }
+    if (entradas.empty()) entradas.push_back("programa.asm");
+    if (entradas.size() > 1 && !archivo_salida.empty()) {
+        cerr << "-o sólo admite un archivo de entrada; use -d para varios" << endl;
+        return 2;
+    }
+    if (stats) asignaciones::activo.store(true, memory_order_relaxed);
+    auto modulos = make_shared<CacheModulos>(directorio_modulos);
+    // Con --stats o --analisis hay que ensamblar de verdad para medir, y para
+    // exportar símbolos hace falta el ensamblador con sus tablas
+    const bool exportar = !mapa_perf.empty() || !simbolos_gdb.empty();
+    unique_ptr<CacheSalidas> cache;
+    if (!directorio_cache.empty() && !stats && !analisis && !exportar) {
+        cache.reset(new CacheSalidas(directorio_cache, limite_cache_mb << 20));
+    }
+
+    if (continuo) {
+        // La salida continua nunca tiene el programa entero: nada que necesite
+        // verlo completo al final
+        const char* incompatible = formato != "bin" && formato != "hex" ? "-f elf/exe"
+                                 : entradas.size() > 1 ? "varios archivos de entrada"
+                                 : codigo.flujo ? "-O2"
+                                 : codigo.bucles.alineacion > 1 ? "--alinear-bucles"
+                                 : hilos >= 0 ? "-j"
+                                 : vigilancia ? "--watch"
+                                 : analisis ? "--analisis"
+                                 : exportar ? "--mapa-perf/--simbolos-gdb"
+                                 : !directorio_cache.empty() ? "--cache" : nullptr;
+        if (incompatible) {
+            cerr << "--stream no admite " << incompatible << endl;
+            return 2;
+        }
+    }
+
+    // 1. Varios archivos: en paralelo, un archivo por tarea
+    if (entradas.size() > 1) {
+        if (vigilancia || analisis || exportar) {
+            cerr << (vigilancia ? "--watch" : analisis ? "--analisis" : "--mapa-perf/--simbolos-gdb")
+                 << " sólo admite un archivo de entrada" << endl;
+            return 2;
+        }
+        return ensamblar_lote(entradas, formato, directorio, hilos < 0 ? 0 : static_cast<unsigned>(hilos),
+                              reportes, codigo, stats, archivo_stats, modulos, cache.get());
+    }
+
+    // 2. Un solo archivo
+    const string& entrada = entradas[0];
+    if (archivo_salida.empty()) archivo_salida = nombre_salida(entrada, formato, directorio);
+    if (vigilancia) return vigilar(entrada, archivo_salida, formato, codigo);
+    if (continuo) return ensamblar_continuo(entrada, archivo_salida, formato, codigo, stats, archivo_stats);
+
+    ostream sin_salida(nullptr);
+    ostream& mensajes = (stats && archivo_stats.empty()) ? sin_salida : cout;
+
+    uint64_t clave = 0;
+    const bool con_cache = cache && clave_de_archivo(entrada, formato, codigo.clave(), clave);
+    if (con_cache) {
+        const string archivo_simbolos = "simbolos.txt", archivo_referencias = "referencias.txt";
+        ResultadoArchivo r;
+        if (restaurar_salida(*cache, clave, formato, archivo_salida, &archivo_simbolos, &archivo_referencias,
+                             r.diagnosticos)) {
+            mensajes << "Salida restaurada de la caché: " << entrada << " no ha cambiado" << endl;
+            mostrar_cache(mensajes, *cache);
+            contar_diagnosticos(r);
+            cerr << r.diagnosticos;
+            return r.errores > 0 ? 1 : 0;
+        }
+    }
+
+    EnsambladorIA32 ensamblador;
+    if (stats) ensamblador.activar_estadisticas();
+    codigo.aplicar(ensamblador);
+    ensamblador.activar_analisis(analisis);
+    ensamblador.fijar_cache_modulos(modulos);
+
+    ostringstream diagnosticos;
+    ensamblador.fijar_diagnosticos(diagnosticos);
+
+    if (hilos >= 0) {
+        mensajes << "Iniciando ensamblado en paralelo de " << entrada << "..." << endl;
+        ensamblador.ensamblar_paralelo(entrada, static_cast<unsigned>(hilos));
+    } else {
+        mensajes << "Iniciando ensamblado en una sola pasada de " << entrada << "..." << endl;
+        ensamblador.ensamblar(entrada);
+    }
+    
+    mensajes << "Resolviendo referencias pendientes..." << endl;
+    ensamblador.resolver_referencias_pendientes();
+    
+    mensajes << "Generando salida (" << formato << ") y reportes..." << endl;
+    if (con_cache) generar_y_guardar(*cache, clave, ensamblador, formato, archivo_salida, diagnosticos);
+    else generar_salida(ensamblador, formato, archivo_salida);
+    ensamblador.generar_reportes();
+    
+    if (codigo.optimizar) mostrar_optimizaciones(mensajes, ensamblador.informe_optimizacion());
+    mostrar_modulos(mensajes, *modulos);
+    if (cache) mostrar_cache(mensajes, *cache);
+    if (analisis) {
+        if (archivo_analisis.empty()) ensamblador.generar_analisis(mensajes);
+        else ensamblador.generar_analisis(archivo_analisis);
+    }
+    const bool exportados = !exportar || exportar_simbolos(ensamblador, mapa_perf, simbolos_gdb);
+    mensajes << "Proceso completado. Revise " << archivo_salida << ", simbolos.txt y referencias.txt" << endl;
+
+    ResultadoArchivo r;
+    r.diagnosticos = diagnosticos.str();
+    contar_diagnosticos(r);
+    cerr << r.diagnosticos;
+
+    if (stats) escribir_estadisticas(ensamblador.consultar_estadisticas(), archivo_stats);
+    return r.errores > 0 || !exportados ? 1 : 0;
+}
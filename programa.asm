@@ -11,10 +11,10 @@ mov eax, 1                  ;B8 01 00 00 00
 
 calcular:
 cmp ecx, 1                  ;83 F9 01
-jle fin                     ;7E 05
+jle fin                     ;7E 06
 imul eax, ecx               ;0F AF C1
 dec ecx                     ;49
-jmp calcular                ;EB F4
+jmp calcular                ;EB F5
 
 fin:
 mov [resultado], eax        ;A3 [addr resultado]